@@ -1,76 +1,61 @@
-// TODO[rsmekens]: compiler flag for macos
-//#include "SDL_Renderer.h"
-#include "SPixelGameEngine.h"
-
-#include <iostream>
-#include <math.h>
-
-
-// class Graphing : public PixelGameEngine
-// {
-// public:
-// 	float worldTime = 0.0f;
-//
-// 	Graphing() 
-// 	{
-// 	}
-//
-// 	double f(double x)
-// 	{
-// 		return sin(x);
-// 	}
-//
-// 	virtual void Initialize() override
-// 	{
-//
-// 	}
-//
-// 	virtual void UpdateGame(float deltaTime) override
-// 	{
-// 	worldTime += deltaTime;
-// 	
-// 	int Width = WindowData.width;
-// 	int Height = WindowData.height;
-// 	
-// 	// Draw our axes
-// 	DrawLine(0, Height / 2, Width, Height / 2, LightGray);
-// 	DrawLine(Width / 2, 0, Width / 2, Height, LightGray);
-//
-// 	for (int p = 0; p < Width; ++p)
-// 	{
-// 		// We'll need to transform from our pixel coordinate system to the usual Cartesian coordinates
-// 		double x = p;
-//
-// 		// First, shift x=0 to the center of the screen (instead of the left edge)
-// 		x -= Width / 2;
-//
-// 		// Scale x down, effectively setting our graph's "Window" to something like w=(-8, 8), h=(-6, 6)
-// 		x /= 10.0;
-//
-// 		x -= worldTime;
-//
-// 		// Run the function!
-// 		double y = f(x);
-//
-// 		// Now we have to scale our result back up
-// 		y *= 100;
-//
-// 		// In computer graphics, y increases downward
-// 		// In Cartesian coordinates, y increases upward
-// 		y = -y;
-//
-// 		// Finally, shift it to the center of the screen (instead of the top edge)
-// 		y += Height / 2;
-//
-// 		DrawPoint(p, (int)y, LightRed);
-// 	}
-// 	}
-// };
-
-int main()
+#include "SEngine.h"
+
+#include <cmath>
+#include <vector>
+
+static float worldTime = 0.0f;
+static std::vector<RasterPoint> plot;
+
+static double f(double x)
+{
+	return sin(x);
+}
+
+void Start()
 {
-	std::cout << "Main" << std::endl;
-	return 0;
-	//Graphing app;
-	//return app.Start();
-}
\ No newline at end of file
+	SetApplicationName("Graphing");
+	plot.resize(Width);
+}
+
+void Tick(float deltaTime)
+{
+	worldTime += deltaTime;
+
+	Clear();
+
+	// Draw our axes
+	DrawLine(0, Height / 2, Width, Height / 2, LightGray);
+	DrawLine(Width / 2, 0, Width / 2, Height, LightGray);
+
+	for (int32 p = 0; p < Width; ++p)
+	{
+		// We'll need to transform from our pixel coordinate system to the usual Cartesian coordinates
+		double x = p;
+
+		// First, shift x=0 to the center of the screen (instead of the left edge)
+		x -= Width / 2;
+
+		// Scale x down, effectively setting our graph's "Window" to something like w=(-16, 16), h=(-1.2, 1.2)
+		x /= 10.0;
+
+		x -= worldTime;
+
+		// Run the function!
+		double y = f(x);
+
+		// Now we have to scale our result back up
+		y *= 100;
+
+		// In computer graphics, y increases downward
+		// In Cartesian coordinates, y increases upward
+		y = -y;
+
+		// Finally, shift it to the center of the screen (instead of the top edge)
+		y += Height / 2;
+
+		plot[p] = RasterPoint { p, static_cast<int32>(y) };
+	}
+
+	// Connecting the samples keeps the curve solid where it is steep
+	DrawPolyline(plot, LightRed);
+}
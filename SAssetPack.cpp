@@ -0,0 +1,249 @@
+#include "SAssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint64 PackAlignment = 64;
+
+static uint64 AlignUp(uint64 value)
+{
+	return (value + PackAlignment - 1) & ~(PackAlignment - 1);
+}
+
+bool WriteAssetPack(const std::string& path, std::vector<CookedImage> images)
+{
+	std::sort(images.begin(), images.end(), [](const CookedImage& lhs, const CookedImage& rhs) { return lhs.name < rhs.name; });
+
+	AssetPackHeader header {};
+	header.magic = AssetPackHeader::Magic;
+	header.version = AssetPackHeader::CurrentVersion;
+	header.imageCount = static_cast<uint32>(images.size());
+	header.namesOffset = static_cast<uint32>(sizeof(AssetPackHeader) + images.size() * sizeof(AssetPackEntry));
+
+	std::vector<AssetPackEntry> entries(images.size());
+	std::string names;
+	uint64 pixelOffset = 0;
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const CookedImage& image = images[i];
+		AssetPackEntry& entry = entries[i];
+		entry.nameOffset = static_cast<uint32>(names.size());
+		entry.nameLength = static_cast<uint32>(image.name.size());
+		entry.width = image.width;
+		entry.height = image.height;
+		entry.pitch = static_cast<int32>(AlignUp(image.width * sizeof(uint32)) / sizeof(uint32));
+		entry.cellCountX = std::max(image.cellCountX, 1);
+		entry.cellCountY = std::max(image.cellCountY, 1);
+		names += image.name;
+	}
+
+	// Pixels follow the names, the first image starts on the next 64 byte boundary
+	pixelOffset = AlignUp(header.namesOffset + names.size());
+	for (AssetPackEntry& entry : entries)
+	{
+		entry.pixelOffset = pixelOffset;
+		pixelOffset = AlignUp(pixelOffset + static_cast<uint64>(entry.pitch) * entry.height * sizeof(uint32));
+	}
+	header.fileSize = pixelOffset;
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetPackEntry));
+	file.write(names.data(), names.size());
+
+	uint64 written = header.namesOffset + names.size();
+	std::vector<uint32> row;
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const CookedImage& image = images[i];
+		const AssetPackEntry& entry = entries[i];
+
+		const std::vector<char> padding(entry.pixelOffset - written, 0);
+		file.write(padding.data(), padding.size());
+
+		row.assign(entry.pitch, 0);
+		for (int32 y = 0; y < image.height; y++)
+		{
+			std::copy(image.pixels.begin() + static_cast<size_t>(y) * image.width, image.pixels.begin() + static_cast<size_t>(y + 1) * image.width, row.begin());
+			file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(uint32));
+		}
+		written = entry.pixelOffset + static_cast<uint64>(entry.pitch) * entry.height * sizeof(uint32);
+	}
+
+	const std::vector<char> padding(header.fileSize - written, 0);
+	file.write(padding.data(), padding.size());
+	return static_cast<bool>(file);
+}
+
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+bool AssetPack::Open(const std::string& path)
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = GetFileSizeEx(file, &fileSize) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr)
+	{
+		if (mapping != nullptr)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const uint8*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat fileStat;
+	void* view = fstat(file, &fileStat) == 0 && fileStat.st_size > 0 ? mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	// The mapping keeps the file alive on its own
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	data = static_cast<const uint8*>(view);
+	size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+	// Reject anything that would make a lookup read outside of the mapping
+	bool bValid = size >= sizeof(AssetPackHeader);
+	bValid = bValid && GetHeader().magic == AssetPackHeader::Magic && GetHeader().version == AssetPackHeader::CurrentVersion && GetHeader().fileSize == size;
+	bValid = bValid && GetHeader().namesOffset == sizeof(AssetPackHeader) + static_cast<uint64>(GetHeader().imageCount) * sizeof(AssetPackEntry);
+	bValid = bValid && GetHeader().namesOffset <= size;
+	for (uint32 i = 0; bValid && i < GetHeader().imageCount; i++)
+	{
+		const AssetPackEntry& entry = GetEntries()[i];
+		const uint64 pixelBytes = static_cast<uint64>(entry.pitch) * entry.height * sizeof(uint32);
+		bValid = static_cast<uint64>(GetHeader().namesOffset) + entry.nameOffset + entry.nameLength <= size
+			&& entry.width >= 0 && entry.height >= 0 && entry.pitch >= entry.width
+			&& entry.pixelOffset % PackAlignment == 0 && entry.pixelOffset + pixelBytes <= size;
+	}
+	if (!bValid)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void AssetPack::Close()
+{
+	if (data == nullptr)
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	UnmapViewOfFile(data);
+	CloseHandle(static_cast<HANDLE>(mappingHandle));
+	CloseHandle(static_cast<HANDLE>(fileHandle));
+#else
+	munmap(const_cast<uint8*>(data), size);
+#endif
+	data = nullptr;
+	size = 0;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+uint32 AssetPack::GetImageCount() const
+{
+	return IsOpen() ? GetHeader().imageCount : 0;
+}
+
+const AssetPackEntry* AssetPack::FindEntry(const std::string& name) const
+{
+	if (!IsOpen())
+	{
+		return nullptr;
+	}
+
+	const char* names = reinterpret_cast<const char*>(data + GetHeader().namesOffset);
+	auto compare = [&](const AssetPackEntry& entry) -> int
+	{
+		const int result = std::memcmp(names + entry.nameOffset, name.data(), std::min<size_t>(entry.nameLength, name.size()));
+		if (result != 0)
+		{
+			return result;
+		}
+		return entry.nameLength < name.size() ? -1 : (entry.nameLength > name.size() ? 1 : 0);
+	};
+
+	const AssetPackEntry* entries = GetEntries();
+	uint32 low = 0;
+	uint32 high = GetHeader().imageCount;
+	while (low < high)
+	{
+		const uint32 middle = low + (high - low) / 2;
+		const int result = compare(entries[middle]);
+		if (result == 0)
+		{
+			return &entries[middle];
+		}
+		if (result < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return nullptr;
+}
+
+std::string AssetPack::GetName(const AssetPackEntry& entry) const
+{
+	return std::string(reinterpret_cast<const char*>(data + GetHeader().namesOffset + entry.nameOffset), entry.nameLength);
+}
+
+bool AssetPack::FindImage(const std::string& name, SImage& outImage) const
+{
+	const AssetPackEntry* entry = FindEntry(name);
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	outImage.assetPath = name;
+	// SImage has no const pixels, the mapping is read only so nothing may write through this pointer
+	outImage.pixels = reinterpret_cast<Color*>(const_cast<uint8*>(data + entry->pixelOffset));
+	outImage.width = entry->width;
+	outImage.height = entry->height;
+	outImage.pitch = entry->pitch;
+	return true;
+}
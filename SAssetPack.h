@@ -0,0 +1,92 @@
+#pragma once
+
+#include "SEngine.h"
+
+#include <string>
+#include <vector>
+
+// Pack of pre-decoded images, written offline by assetcooker.cpp and memory mapped at runtime.
+// Images handed out by an AssetPack point straight into the mapping, nothing gets decoded or copied.
+//
+// File layout, little endian:
+//   AssetPackHeader
+//   AssetPackEntry[imageCount], sorted by name
+//   names, not null terminated
+//   pixels, 0xAARRGGBB, every image starts 64 byte aligned and every row is padded to a multiple of 64 bytes
+
+struct AssetPackHeader
+{
+	static constexpr uint32 Magic = 0x4B415053; // "SPAK"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 magic;
+	uint32 version;
+	uint32 imageCount;
+	uint32 namesOffset;
+	uint64 fileSize;
+};
+
+struct AssetPackEntry
+{
+	uint32 nameOffset;
+	uint32 nameLength;
+	int32 width;
+	int32 height;
+	// Row distance in pixels
+	int32 pitch;
+	// Sprite sheet layout, 1 x 1 for plain images
+	int32 cellCountX;
+	int32 cellCountY;
+	uint32 reserved;
+	uint64 pixelOffset;
+};
+
+static_assert(sizeof(AssetPackHeader) == 24, "AssetPackHeader is part of the file format");
+static_assert(sizeof(AssetPackEntry) == 40, "AssetPackEntry is part of the file format");
+
+// Input of WriteAssetPack
+struct CookedImage
+{
+	std::string name;
+	int32 width = 0;
+	int32 height = 0;
+	int32 cellCountX = 1;
+	int32 cellCountY = 1;
+	// width * height tightly packed rows
+	std::vector<uint32> pixels;
+};
+
+bool WriteAssetPack(const std::string& path, std::vector<CookedImage> images);
+
+class AssetPack
+{
+public:
+	AssetPack() = default;
+	~AssetPack();
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	// Maps the whole file and validates the directory, images are only touched when they are drawn
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen() const { return data != nullptr; }
+
+	uint32 GetImageCount() const;
+	// Binary search over the sorted directory, nullptr when the pack has no image with that name
+	const AssetPackEntry* FindEntry(const std::string& name) const;
+	std::string GetName(const AssetPackEntry& entry) const;
+
+	// Fills outImage with a view into the pack, the pixels stay valid until the pack gets closed and must not be written
+	bool FindImage(const std::string& name, SImage& outImage) const;
+
+private:
+	const AssetPackHeader& GetHeader() const { return *reinterpret_cast<const AssetPackHeader*>(data); }
+	const AssetPackEntry* GetEntries() const { return reinterpret_cast<const AssetPackEntry*>(data + sizeof(AssetPackHeader)); }
+
+	const uint8* data = nullptr;
+	size_t size = 0;
+	// Platform handles of the mapping
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+};
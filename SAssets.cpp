@@ -0,0 +1,156 @@
+#include "SAssets.h"
+#include "SAssetPack.h"
+
+#include <algorithm>
+#include <iostream>
+
+AssetRegistry::~AssetRegistry()
+{
+	Clear();
+}
+
+void AssetRegistry::MountPack(const AssetPack* pack)
+{
+	mountedPack = pack;
+}
+
+AssetHandle AssetRegistry::Acquire(const std::string& path)
+{
+	const auto found = pathToIndex.find(path);
+	if (found != pathToIndex.end())
+	{
+		Entry& entry = entries[found->second];
+		entry.refCount++;
+		return AssetHandle { found->second, entry.generation };
+	}
+
+	SImage image {};
+	const bool bOwnsPixels = mountedPack == nullptr || !mountedPack->FindImage(path, image);
+	if (bOwnsPixels)
+	{
+		const PngError error = SLoadImage(path, image);
+		if (error != PngError::None)
+		{
+			std::cout << "Failed to load image " << path << ": " << GetPngErrorName(error) << std::endl;
+		}
+	}
+	return AddEntry(path, image, bOwnsPixels, 1);
+}
+
+std::vector<AssetHandle> AssetRegistry::Acquire(const std::vector<std::string>& paths)
+{
+	// Everything that is neither loaded nor packed gets decoded in one parallel batch
+	std::vector<std::string> decodePaths;
+	for (const std::string& path : paths)
+	{
+		const bool bKnown = pathToIndex.count(path) != 0 || (mountedPack != nullptr && mountedPack->FindEntry(path) != nullptr);
+		if (!bKnown && std::find(decodePaths.begin(), decodePaths.end(), path) == decodePaths.end())
+		{
+			decodePaths.push_back(path);
+		}
+	}
+
+	std::vector<SImage> images;
+	const std::vector<PngError> errors = SLoadImages(decodePaths, images);
+	for (size_t i = 0; i < decodePaths.size(); i++)
+	{
+		if (errors[i] != PngError::None)
+		{
+			std::cout << "Failed to load image " << decodePaths[i] << ": " << GetPngErrorName(errors[i]) << std::endl;
+		}
+		// The Acquire below takes the first reference
+		AddEntry(decodePaths[i], images[i], true, 0);
+	}
+
+	std::vector<AssetHandle> handles;
+	handles.reserve(paths.size());
+	for (const std::string& path : paths)
+	{
+		handles.push_back(Acquire(path));
+	}
+	return handles;
+}
+
+AssetHandle AssetRegistry::AddEntry(const std::string& path, const SImage& image, bool bOwnsPixels, uint32 refCount)
+{
+	uint32 index;
+	if (!freeIndices.empty())
+	{
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32>(entries.size());
+		entries.emplace_back();
+	}
+
+	Entry& entry = entries[index];
+	entry.image = image;
+	entry.bOwnsPixels = bOwnsPixels;
+	entry.refCount = refCount;
+	pathToIndex.emplace(path, index);
+	return AssetHandle { index, entry.generation };
+}
+
+void AssetRegistry::AddRef(AssetHandle handle)
+{
+	if (IsAlive(handle))
+	{
+		entries[handle.index].refCount++;
+	}
+}
+
+void AssetRegistry::Release(AssetHandle handle)
+{
+	if (!IsAlive(handle))
+	{
+		return;
+	}
+
+	Entry& entry = entries[handle.index];
+	entry.refCount--;
+	if (entry.refCount > 0)
+	{
+		return;
+	}
+
+	pathToIndex.erase(entry.image.assetPath);
+	FreeEntry(entry);
+	freeIndices.push_back(handle.index);
+}
+
+bool AssetRegistry::IsAlive(AssetHandle handle) const
+{
+	return handle.index < entries.size() && entries[handle.index].generation == handle.generation && entries[handle.index].refCount > 0;
+}
+
+const SImage& AssetRegistry::GetImage(AssetHandle handle) const
+{
+	static const SImage EmptyImage {};
+	return IsAlive(handle) ? entries[handle.index].image : EmptyImage;
+}
+
+void AssetRegistry::Clear()
+{
+	freeIndices.clear();
+	for (uint32 index = 0; index < entries.size(); index++)
+	{
+		Entry& entry = entries[index];
+		FreeEntry(entry);
+		entry.refCount = 0;
+		freeIndices.push_back(index);
+	}
+	pathToIndex.clear();
+}
+
+void AssetRegistry::FreeEntry(Entry& entry)
+{
+	if (entry.bOwnsPixels)
+	{
+		SFreeImage(entry.image);
+	}
+	entry.image = {};
+	entry.bOwnsPixels = false;
+	entry.generation++;
+}
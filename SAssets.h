@@ -0,0 +1,69 @@
+#pragma once
+
+#include "SEngine.h"
+
+class AssetPack;
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Handle to an image in an AssetRegistry. Stays cheap to copy and compare, and goes stale instead of dangling
+// once the image it points to has been freed.
+struct AssetHandle
+{
+	static constexpr uint32 InvalidIndex = 0xFFFFFFFF;
+
+	uint32 index = InvalidIndex;
+	uint32 generation = 0;
+
+	bool IsValid() const { return index != InvalidIndex; }
+	bool operator==(const AssetHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const AssetHandle& other) const { return !(*this == other); }
+};
+
+// Loads every image path once and reference counts it, the pixels are freed when the last reference is released.
+// Look ups by handle are an index and a generation compare, only Acquire hashes the path.
+class AssetRegistry
+{
+public:
+	~AssetRegistry();
+
+	// Images found in a mounted pack are handed out as views into its mapping instead of being decoded.
+	// The pack has to stay open for as long as the registry holds any of its images, nullptr unmounts it.
+	void MountPack(const AssetPack* pack);
+
+	// Loads the image the first time its path is seen, returns a handle that holds one reference.
+	// A failed load still gives a valid handle to an empty image, so it isn't retried every call.
+	AssetHandle Acquire(const std::string& path);
+	// Same as calling Acquire for every path, but all images that need decoding are decoded in parallel
+	std::vector<AssetHandle> Acquire(const std::vector<std::string>& paths);
+	// Adds a reference to an image that is already loaded, no hashing or allocation
+	void AddRef(AssetHandle handle);
+	void Release(AssetHandle handle);
+
+	bool IsAlive(AssetHandle handle) const;
+	// Returns an empty image without pixels for stale handles, drawing it does nothing
+	const SImage& GetImage(AssetHandle handle) const;
+
+	// Frees every image, all handles handed out so far go stale
+	void Clear();
+
+private:
+	struct Entry
+	{
+		SImage image {};
+		uint32 refCount = 0;
+		uint32 generation = 0;
+		// False for views into a mounted pack, those pixels belong to the mapping
+		bool bOwnsPixels = false;
+	};
+
+	AssetHandle AddEntry(const std::string& path, const SImage& image, bool bOwnsPixels, uint32 refCount);
+	void FreeEntry(Entry& entry);
+
+	std::vector<Entry> entries;
+	std::vector<uint32> freeIndices;
+	std::unordered_map<std::string, uint32> pathToIndex;
+	const AssetPack* mountedPack = nullptr;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Tiny micro-benchmark harness shared by benchmark.cpp (SEngine) and benchmark_sdl.cpp (SDL_Renderer).
+// Every case is repeated until it ran for at least minSeconds, results are printed as a table and written as json.
+
+struct BenchmarkResult
+{
+	std::string name;
+	// Free form description of the sweep parameters, e.g. "size=64"
+	std::string parameters;
+	uint64 operations;
+	// Pixels written by a single operation
+	uint64 pixelsPerOperation;
+	double seconds;
+
+	double GetNsPerOperation() const { return operations > 0 ? seconds * 1e9 / operations : 0.0; }
+	double GetPixelsPerSecond() const { return seconds > 0.0 ? pixelsPerOperation * operations / seconds : 0.0; }
+};
+
+class BenchmarkRunner
+{
+public:
+	double minSeconds = 0.05;
+
+	// func does operationsPerCall operations every time it gets called
+	template<typename Func>
+	const BenchmarkResult& Run(const std::string& name, const std::string& parameters, uint64 pixelsPerOperation, uint64 operationsPerCall, Func&& func)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		// Warm up caches and lazily built tables before timing anything
+		func();
+
+		uint64 calls = 1;
+		double seconds = 0.0;
+		while (true)
+		{
+			const Clock::time_point start = Clock::now();
+			for (uint64 i = 0; i < calls; i++)
+			{
+				func();
+			}
+			seconds = std::chrono::duration<double>(Clock::now() - start).count();
+			if (seconds >= minSeconds)
+			{
+				break;
+			}
+			calls *= 2;
+		}
+
+		results.push_back(BenchmarkResult { name, parameters, calls * operationsPerCall, pixelsPerOperation, seconds });
+		const BenchmarkResult& result = results.back();
+		std::printf("%-28s %-22s %12.1f ns/op %10.1f Mpixels/s\n", name.c_str(), parameters.c_str(), result.GetNsPerOperation(), result.GetPixelsPerSecond() / 1e6);
+		return result;
+	}
+
+	const std::vector<BenchmarkResult>& GetResults() const { return results; }
+
+	bool WriteJson(const std::string& path) const
+	{
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			return false;
+		}
+
+		std::fputs("[\n", file);
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const BenchmarkResult& result = results[i];
+			std::fprintf(file, "  {\"name\": \"%s\", \"parameters\": \"%s\", \"operations\": %llu, \"pixels_per_operation\": %llu, \"ns_per_operation\": %.3f, \"pixels_per_second\": %.1f}%s\n",
+				result.name.c_str(), result.parameters.c_str(), static_cast<unsigned long long>(result.operations),
+				static_cast<unsigned long long>(result.pixelsPerOperation), result.GetNsPerOperation(), result.GetPixelsPerSecond(),
+				i + 1 < results.size() ? "," : "");
+		}
+		std::fputs("]\n", file);
+		return std::fclose(file) == 0;
+	}
+
+private:
+	std::vector<BenchmarkResult> results;
+};
+
+// Parses "--out path" and "--min-time seconds", returns the json path or an empty string
+inline std::string ParseBenchmarkArguments(int argc, const char* const* argv, BenchmarkRunner& runner)
+{
+	std::string outputPath;
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--out")
+		{
+			outputPath = argv[++i];
+		}
+		else if (argument == "--min-time")
+		{
+			runner.minSeconds = std::atof(argv[++i]);
+		}
+	}
+	return outputPath;
+}
@@ -0,0 +1,325 @@
+#include "SBlit.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Both kernels only need SSE2 level instructions, so every x64 build gets at least the 4 pixel version
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SBLIT_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SBLIT_SSE2 1
+#endif
+
+static constexpr uint32 OpaqueAlpha = 0xFF000000;
+
+// SCALAR
+
+// Alpha 0..255 as a weight of 0..256, so fully opaque and fully transparent sources blend exactly
+static uint32 ToWeight(uint32 alpha)
+{
+	return alpha + (alpha >> 7);
+}
+
+template<BlendMode Mode>
+static uint32 BlendChannel(uint32 dst, uint32 src, uint32 weight)
+{
+	if constexpr (Mode == BlendMode::Alpha)
+	{
+		return (src * weight + dst * (256 - weight)) >> 8;
+	}
+	else if constexpr (Mode == BlendMode::PremultipliedAlpha)
+	{
+		return std::min(src + ((dst * (256 - weight)) >> 8), 255u);
+	}
+	else if constexpr (Mode == BlendMode::Additive)
+	{
+		return std::min(dst + ((src * weight) >> 8), 255u);
+	}
+	else
+	{
+		// Fade the source towards white by its alpha, then multiply
+		const uint32 factor = 255 - (((255 - src) * weight) >> 8);
+		return (dst * ToWeight(factor)) >> 8;
+	}
+}
+
+template<BlendMode Mode>
+static uint32 BlendPixel(uint32 dst, uint32 src, uint32 colorKey)
+{
+	if constexpr (Mode == BlendMode::Opaque)
+	{
+		return src | OpaqueAlpha;
+	}
+	else if constexpr (Mode == BlendMode::ColorKey)
+	{
+		const uint32 keepMask = 0u - static_cast<uint32>(((src ^ colorKey) & 0x00FFFFFF) == 0);
+		return (dst & keepMask) | ((src | OpaqueAlpha) & ~keepMask);
+	}
+	else
+	{
+		const uint32 weight = ToWeight(src >> 24);
+		const uint32 blue = BlendChannel<Mode>(dst & 0xFF, src & 0xFF, weight);
+		const uint32 green = BlendChannel<Mode>((dst >> 8) & 0xFF, (src >> 8) & 0xFF, weight);
+		const uint32 red = BlendChannel<Mode>((dst >> 16) & 0xFF, (src >> 16) & 0xFF, weight);
+		return OpaqueAlpha | (red << 16) | (green << 8) | blue;
+	}
+}
+
+template<BlendMode Mode>
+static void BlendSpanScalar(uint32* dest, const uint32* src, int32 count, uint32 colorKey)
+{
+	for (int32 i = 0; i < count; i++)
+	{
+		dest[i] = BlendPixel<Mode>(dest[i], src[i], colorKey);
+	}
+}
+
+// ~SCALAR
+
+// SIMD
+
+#if SBLIT_AVX2 || SBLIT_SSE2
+
+// The kernels unpack pixels to 16 bit channels, 2 pixels per 128 bits. Unpacking and packing both work per 128 bit lane,
+// so the same code is correct for SSE2 and AVX2.
+
+#if SBLIT_AVX2
+struct SimdPixels
+{
+	using Vector = __m256i;
+	static constexpr int32 PixelCount = 8;
+
+	static Vector Load(const uint32* pixels) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels)); }
+	static void Store(uint32* pixels, Vector value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), value); }
+	static Vector Set32(uint32 value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+	static Vector Set16(uint16 value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+	static Vector UnpackLow(Vector value) { return _mm256_unpacklo_epi8(value, _mm256_setzero_si256()); }
+	static Vector UnpackHigh(Vector value) { return _mm256_unpackhi_epi8(value, _mm256_setzero_si256()); }
+	static Vector Pack(Vector low, Vector high) { return _mm256_packus_epi16(low, high); }
+	static Vector Add16(Vector a, Vector b) { return _mm256_add_epi16(a, b); }
+	static Vector Sub16(Vector a, Vector b) { return _mm256_sub_epi16(a, b); }
+	static Vector Mul16(Vector a, Vector b) { return _mm256_mullo_epi16(a, b); }
+	static Vector AddSaturate8(Vector a, Vector b) { return _mm256_adds_epu8(a, b); }
+	static Vector Equal32(Vector a, Vector b) { return _mm256_cmpeq_epi32(a, b); }
+	static Vector And(Vector a, Vector b) { return _mm256_and_si256(a, b); }
+	static Vector AndNot(Vector a, Vector b) { return _mm256_andnot_si256(a, b); }
+	static Vector Or(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+	template<int Bits> static Vector ShiftRight16(Vector value) { return _mm256_srli_epi16(value, Bits); }
+	// Copies the alpha channel of each unpacked pixel into its other 3 channels
+	static Vector BroadcastAlpha(Vector value) { return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(value, 0xFF), 0xFF); }
+};
+#else
+struct SimdPixels
+{
+	using Vector = __m128i;
+	static constexpr int32 PixelCount = 4;
+
+	static Vector Load(const uint32* pixels) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)); }
+	static void Store(uint32* pixels, Vector value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value); }
+	static Vector Set32(uint32 value) { return _mm_set1_epi32(static_cast<int>(value)); }
+	static Vector Set16(uint16 value) { return _mm_set1_epi16(static_cast<short>(value)); }
+	static Vector UnpackLow(Vector value) { return _mm_unpacklo_epi8(value, _mm_setzero_si128()); }
+	static Vector UnpackHigh(Vector value) { return _mm_unpackhi_epi8(value, _mm_setzero_si128()); }
+	static Vector Pack(Vector low, Vector high) { return _mm_packus_epi16(low, high); }
+	static Vector Add16(Vector a, Vector b) { return _mm_add_epi16(a, b); }
+	static Vector Sub16(Vector a, Vector b) { return _mm_sub_epi16(a, b); }
+	static Vector Mul16(Vector a, Vector b) { return _mm_mullo_epi16(a, b); }
+	static Vector AddSaturate8(Vector a, Vector b) { return _mm_adds_epu8(a, b); }
+	static Vector Equal32(Vector a, Vector b) { return _mm_cmpeq_epi32(a, b); }
+	static Vector And(Vector a, Vector b) { return _mm_and_si128(a, b); }
+	static Vector AndNot(Vector a, Vector b) { return _mm_andnot_si128(a, b); }
+	static Vector Or(Vector a, Vector b) { return _mm_or_si128(a, b); }
+	template<int Bits> static Vector ShiftRight16(Vector value) { return _mm_srli_epi16(value, Bits); }
+	// Copies the alpha channel of each unpacked pixel into its other 3 channels
+	static Vector BroadcastAlpha(Vector value) { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xFF), 0xFF); }
+};
+#endif
+
+using Vector = SimdPixels::Vector;
+
+// Same math as BlendChannel, on unpacked 16 bit channels. Nothing overflows 16 bits, the largest product is 255 * 256.
+template<BlendMode Mode>
+static Vector BlendChannels(Vector dst, Vector src)
+{
+	using S = SimdPixels;
+	const Vector alpha = S::BroadcastAlpha(src);
+	const Vector weight = S::Add16(alpha, S::ShiftRight16<7>(alpha));
+	const Vector inverseWeight = S::Sub16(S::Set16(256), weight);
+
+	if constexpr (Mode == BlendMode::Alpha)
+	{
+		return S::ShiftRight16<8>(S::Add16(S::Mul16(src, weight), S::Mul16(dst, inverseWeight)));
+	}
+	else if constexpr (Mode == BlendMode::PremultipliedAlpha)
+	{
+		// The saturating add happens after packing
+		return S::ShiftRight16<8>(S::Mul16(dst, inverseWeight));
+	}
+	else if constexpr (Mode == BlendMode::Additive)
+	{
+		return S::ShiftRight16<8>(S::Mul16(src, weight));
+	}
+	else
+	{
+		const Vector white = S::Set16(255);
+		const Vector factor = S::Sub16(white, S::ShiftRight16<8>(S::Mul16(S::Sub16(white, src), weight)));
+		return S::ShiftRight16<8>(S::Mul16(dst, S::Add16(factor, S::ShiftRight16<7>(factor))));
+	}
+}
+
+template<BlendMode Mode>
+static Vector BlendPixels(Vector dst, Vector src, Vector colorKey)
+{
+	using S = SimdPixels;
+	const Vector opaqueAlpha = S::Set32(OpaqueAlpha);
+
+	if constexpr (Mode == BlendMode::Opaque)
+	{
+		return S::Or(src, opaqueAlpha);
+	}
+	else if constexpr (Mode == BlendMode::ColorKey)
+	{
+		const Vector keepMask = S::Equal32(S::AndNot(opaqueAlpha, src), colorKey);
+		return S::Or(S::And(keepMask, dst), S::AndNot(keepMask, S::Or(src, opaqueAlpha)));
+	}
+	else
+	{
+		const Vector low = BlendChannels<Mode>(S::UnpackLow(dst), S::UnpackLow(src));
+		const Vector high = BlendChannels<Mode>(S::UnpackHigh(dst), S::UnpackHigh(src));
+		Vector result = S::Pack(low, high);
+		if constexpr (Mode == BlendMode::PremultipliedAlpha)
+		{
+			result = S::AddSaturate8(result, src);
+		}
+		else if constexpr (Mode == BlendMode::Additive)
+		{
+			result = S::AddSaturate8(result, dst);
+		}
+		return S::Or(result, opaqueAlpha);
+	}
+}
+
+template<BlendMode Mode>
+static void BlendSpanSimd(uint32* dest, const uint32* src, int32 count, uint32 colorKey)
+{
+	const Vector wideColorKey = SimdPixels::Set32(colorKey & 0x00FFFFFF);
+	int32 i = 0;
+	for (; i + SimdPixels::PixelCount <= count; i += SimdPixels::PixelCount)
+	{
+		SimdPixels::Store(dest + i, BlendPixels<Mode>(SimdPixels::Load(dest + i), SimdPixels::Load(src + i), wideColorKey));
+	}
+	BlendSpanScalar<Mode>(dest + i, src + i, count - i, colorKey);
+}
+
+#endif
+
+// ~SIMD
+
+using BlendSpanFunction = void (*)(uint32* dest, const uint32* src, int32 count, uint32 colorKey);
+
+template<BlendMode Mode>
+static void BlendSpanFast(uint32* dest, const uint32* src, int32 count, uint32 colorKey)
+{
+#if SBLIT_AVX2 || SBLIT_SSE2
+	BlendSpanSimd<Mode>(dest, src, count, colorKey);
+#else
+	BlendSpanScalar<Mode>(dest, src, count, colorKey);
+#endif
+}
+
+static BlendSpanFunction GetBlendSpan(BlendMode mode, bool bReference)
+{
+	switch (mode)
+	{
+	case BlendMode::Opaque: return bReference ? BlendSpanScalar<BlendMode::Opaque> : BlendSpanFast<BlendMode::Opaque>;
+	case BlendMode::ColorKey: return bReference ? BlendSpanScalar<BlendMode::ColorKey> : BlendSpanFast<BlendMode::ColorKey>;
+	case BlendMode::Alpha: return bReference ? BlendSpanScalar<BlendMode::Alpha> : BlendSpanFast<BlendMode::Alpha>;
+	case BlendMode::PremultipliedAlpha: return bReference ? BlendSpanScalar<BlendMode::PremultipliedAlpha> : BlendSpanFast<BlendMode::PremultipliedAlpha>;
+	case BlendMode::Additive: return bReference ? BlendSpanScalar<BlendMode::Additive> : BlendSpanFast<BlendMode::Additive>;
+	case BlendMode::Multiply: return bReference ? BlendSpanScalar<BlendMode::Multiply> : BlendSpanFast<BlendMode::Multiply>;
+	}
+	return BlendSpanScalar<BlendMode::Opaque>;
+}
+
+// Source columns are looked up for this many destination pixels at a time, so nothing is allocated per blit
+static constexpr int32 ChunkSize = 256;
+
+// Nearest neighbour source coordinate for destination pixel center position, mirrored inside the rectangle when flipped
+static int32 SampleSource(int32 position, float destStart, float destSize, float srcStart, float step, bool bFlip, int32 srcSize)
+{
+	const float offset = position + 0.5f - destStart;
+	const float sample = srcStart + (bFlip ? destSize - offset : offset) * step;
+	return std::clamp(static_cast<int32>(sample), 0, srcSize - 1);
+}
+
+static void BlitWith(const SRasterTarget& target, const BlitSource& source, const BlitParams& params, BlendSpanFunction blendSpan)
+{
+	if (source.pixels == nullptr || source.width <= 0 || source.height <= 0 || params.destWidth <= 0.f || params.destHeight <= 0.f)
+	{
+		return;
+	}
+
+	const int32 startX = std::max(static_cast<int32>(std::round(params.destX)), target.clipMinX);
+	const int32 startY = std::max(static_cast<int32>(std::round(params.destY)), target.clipMinY);
+	const int32 endX = std::min(static_cast<int32>(std::round(params.destX + params.destWidth)), target.clipMaxX);
+	const int32 endY = std::min(static_cast<int32>(std::round(params.destY + params.destHeight)), target.clipMaxY);
+
+	const float stepX = params.srcWidth / params.destWidth;
+	const float stepY = params.srcHeight / params.destHeight;
+	const bool bFlipX = (params.flip & BlitFlipX) != 0;
+	const bool bFlipY = (params.flip & BlitFlipY) != 0;
+
+	int32 srcColumns[ChunkSize];
+	alignas(32) uint32 gathered[ChunkSize];
+	for (int32 chunkX = startX; chunkX < endX; chunkX += ChunkSize)
+	{
+		const int32 count = std::min(ChunkSize, endX - chunkX);
+
+		// Unscaled and unflipped rows can be blended straight from the source
+		bool bContiguous = true;
+		for (int32 i = 0; i < count; i++)
+		{
+			srcColumns[i] = SampleSource(chunkX + i, params.destX, params.destWidth, params.srcX, stepX, bFlipX, source.width);
+			bContiguous = bContiguous && srcColumns[i] == srcColumns[0] + i;
+		}
+
+		for (int32 y = startY; y < endY; y++)
+		{
+			const int32 srcY = SampleSource(y, params.destY, params.destHeight, params.srcY, stepY, bFlipY, source.height);
+			const uint32* srcRow = source.pixels + static_cast<size_t>(srcY) * source.pitch;
+
+			const uint32* src = srcRow + srcColumns[0];
+			if (!bContiguous)
+			{
+				for (int32 i = 0; i < count; i++)
+				{
+					gathered[i] = srcRow[srcColumns[i]];
+				}
+				src = gathered;
+			}
+			blendSpan(target.GetRow(y) + chunkX, src, count, params.colorKey);
+		}
+	}
+}
+
+void Blit(const SRasterTarget& target, const BlitSource& source, const BlitParams& params)
+{
+	BlitWith(target, source, params, GetBlendSpan(params.mode, false));
+}
+
+void BlitReference(const SRasterTarget& target, const BlitSource& source, const BlitParams& params)
+{
+	BlitWith(target, source, params, GetBlendSpan(params.mode, true));
+}
+
+void BlendSpan(BlendMode mode, uint32* dest, const uint32* src, int32 count, uint32 colorKey)
+{
+	GetBlendSpan(mode, false)(dest, src, count, colorKey);
+}
+
+void BlendSpanReference(BlendMode mode, uint32* dest, const uint32* src, int32 count, uint32 colorKey)
+{
+	GetBlendSpan(mode, true)(dest, src, count, colorKey);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SRaster.h"
+#include "Typedefs.h"
+
+// Software image blitter for 0xAARRGGBB pixels. Every blend mode gets its own compiled loop, and clipping, flipping and
+// scaling are resolved into source indices per row before blending, so the per pixel loops have no branches.
+// Uses AVX2 or SSE2 kernels when the compiler targets them, BlitReference is the scalar version they have to match.
+
+enum class BlendMode : uint8
+{
+	// Copies the source, alpha is ignored
+	Opaque,
+	// Copies the source except for pixels whose rgb equals colorKey
+	ColorKey,
+	// Source over destination, weighted by the source alpha
+	Alpha,
+	// Same as Alpha for sources whose rgb is already multiplied by their alpha
+	PremultipliedAlpha,
+	// Adds the source weighted by its alpha, saturating at white
+	Additive,
+	// Multiplies the destination by the source, transparent source pixels multiply by white
+	Multiply,
+};
+
+enum BlitFlip : uint8
+{
+	BlitFlipNone = 0,
+	BlitFlipX = 1 << 0,
+	BlitFlipY = 1 << 1,
+};
+
+struct BlitSource
+{
+	const uint32* pixels;
+	int32 width;
+	int32 height;
+	// Distance between two rows in pixels
+	int32 pitch;
+};
+
+struct BlitParams
+{
+	// Destination rectangle, anything outside the clip rectangle of the target is skipped
+	float destX;
+	float destY;
+	float destWidth;
+	float destHeight;
+	// Source rectangle, sampled nearest neighbour when it differs in size from the destination
+	float srcX;
+	float srcY;
+	float srcWidth;
+	float srcHeight;
+
+	BlendMode mode = BlendMode::Alpha;
+	// BlitFlip bits
+	uint8 flip = BlitFlipNone;
+	uint32 colorKey = 0xFFFF00FF;
+};
+
+// The destination is always written opaque
+void Blit(const SRasterTarget& target, const BlitSource& source, const BlitParams& params);
+void BlitReference(const SRasterTarget& target, const BlitSource& source, const BlitParams& params);
+
+// Blends count pixels of src onto dest
+void BlendSpan(BlendMode mode, uint32* dest, const uint32* src, int32 count, uint32 colorKey);
+void BlendSpanReference(BlendMode mode, uint32* dest, const uint32* src, int32 count, uint32 colorKey);
@@ -1,9 +1,107 @@
 #include "SDL_Renderer.h"
+#include "SHeadless.h"
+#include "SRaster.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <vector>
+
+// All primitives drawn with the same color during a frame are collected here and submitted with one SDL call per
+// primitive type when the batches get flushed. Batches are flushed in the order their color was first used that frame.
+// With SDL 2.0.18 or newer the filled rects of consecutive batches go out as one SDL_RenderGeometry call.
+struct DrawBatch
+{
+	Color color;
+	std::vector<SDL_Point> points;
+	std::vector<SDL_Rect> rects;
+	// Lines that aren't axis aligned can't be merged into rects. Segments that continue where the previous one ended
+	// extend the same strip, lineStripEnds holds one past the last point of every strip.
+	std::vector<SDL_Point> lines;
+	std::vector<size_t> lineStripEnds;
+};
+
+// The first usedBatchCount batches are this frame's colors in first use order, the rest only keep their memory around
+static std::vector<DrawBatch> drawBatches;
+static size_t usedBatchCount = 0;
+static size_t lastBatchIndex = 0;
+
+static Color currentDrawColor = 0;
+static bool bHasDrawColor = false;
+
+static DrawBatch& GetDrawBatch(Color color)
+{
+	if (lastBatchIndex < usedBatchCount && drawBatches[lastBatchIndex].color == color)
+	{
+		return drawBatches[lastBatchIndex];
+	}
+
+	for (size_t i = 0; i < usedBatchCount; i++)
+	{
+		if (drawBatches[i].color == color)
+		{
+			lastBatchIndex = i;
+			return drawBatches[i];
+		}
+	}
+
+	// Take the next slot so the vectors keep their capacity between frames
+	if (usedBatchCount == drawBatches.size())
+	{
+		drawBatches.emplace_back();
+	}
+	lastBatchIndex = usedBatchCount++;
+	drawBatches[lastBatchIndex].color = color;
+	return drawBatches[lastBatchIndex];
+}
+
+static void AddHorizontalLine(DrawBatch& batch, int startX, int endX, int y)
+{
+	if (startX > endX)
+	{
+		std::swap(startX, endX);
+	}
+	batch.rects.push_back(SDL_Rect{ startX, y, endX - startX + 1, 1 });
+}
+
+// Bresenham with both end points, the same pixels SDL draws for a single segment
+static void AddLinePoints(std::vector<SDL_Point>& points, int startX, int startY, int endX, int endY)
+{
+	const int deltaX = std::abs(endX - startX);
+	const int deltaY = -std::abs(endY - startY);
+	const int stepX = startX < endX ? 1 : -1;
+	const int stepY = startY < endY ? 1 : -1;
+	int error = deltaX + deltaY;
+	while (true)
+	{
+		points.push_back(SDL_Point{ startX, startY });
+		if (startX == endX && startY == endY)
+		{
+			break;
+		}
+		const int error2 = 2 * error;
+		if (error2 >= deltaY)
+		{
+			error += deltaY;
+			startX += stepX;
+		}
+		if (error2 <= deltaX)
+		{
+			error += deltaX;
+			startY += stepY;
+		}
+	}
+}
 
 void SetColor(Color newColor)
 {
+	if (bHasDrawColor && newColor == currentDrawColor)
+	{
+		return;
+	}
+	currentDrawColor = newColor;
+	bHasDrawColor = true;
+
 	unsigned int r = (newColor >> 16) & 0xFF;
 	unsigned int g = (newColor >> 8) & 0xFF;
 	unsigned int b = (newColor >> 0) & 0xFF; 
@@ -12,27 +110,141 @@ void SetColor(Color newColor)
 	SDL_SetRenderDrawColor(RenderData.renderer, r, g, b, a);
 }
 
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+// Filled rects of consecutive batches as colored triangles, so they go to SDL in one call instead of one per color
+static std::vector<SDL_Vertex> rectVertices;
+static std::vector<int> rectIndices;
+
+static void AddRectGeometry(const DrawBatch& batch)
+{
+	const SDL_Color color { static_cast<Uint8>((batch.color >> 16) & 0xFF), static_cast<Uint8>((batch.color >> 8) & 0xFF),
+		static_cast<Uint8>(batch.color & 0xFF), static_cast<Uint8>((batch.color >> 24) & 0xFF) };
+	for (const SDL_Rect& rect : batch.rects)
+	{
+		const int first = static_cast<int>(rectVertices.size());
+		const float left = static_cast<float>(rect.x);
+		const float top = static_cast<float>(rect.y);
+		const float right = static_cast<float>(rect.x + rect.w);
+		const float bottom = static_cast<float>(rect.y + rect.h);
+		rectVertices.push_back(SDL_Vertex{ SDL_FPoint{ left, top }, color, SDL_FPoint{ 0.0f, 0.0f } });
+		rectVertices.push_back(SDL_Vertex{ SDL_FPoint{ right, top }, color, SDL_FPoint{ 0.0f, 0.0f } });
+		rectVertices.push_back(SDL_Vertex{ SDL_FPoint{ right, bottom }, color, SDL_FPoint{ 0.0f, 0.0f } });
+		rectVertices.push_back(SDL_Vertex{ SDL_FPoint{ left, bottom }, color, SDL_FPoint{ 0.0f, 0.0f } });
+		const int indices[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+		rectIndices.insert(rectIndices.end(), indices, indices + 6);
+	}
+}
+
+static void FlushRectGeometry()
+{
+	if (!rectIndices.empty())
+	{
+		SDL_RenderGeometry(RenderData.renderer, nullptr, rectVertices.data(), static_cast<int>(rectVertices.size()), rectIndices.data(), static_cast<int>(rectIndices.size()));
+	}
+	rectVertices.clear();
+	rectIndices.clear();
+}
+#endif
+
+void FlushDrawBatches()
+{
+	// Batches that weren't used for a whole frame are dropped, the rest keep their memory for the next frame
+	drawBatches.resize(usedBatchCount);
+
+	for (DrawBatch& batch : drawBatches)
+	{
+		// Lone segments become points, so only strips of connected segments cost a call each
+		size_t stripStart = 0;
+		for (const size_t stripEnd : batch.lineStripEnds)
+		{
+			if (stripEnd - stripStart == 2)
+			{
+				AddLinePoints(batch.points, batch.lines[stripStart].x, batch.lines[stripStart].y, batch.lines[stripStart + 1].x, batch.lines[stripStart + 1].y);
+			}
+			stripStart = stripEnd;
+		}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		// Rects are collected until a batch has points or lines, which have to be drawn on top of the rects before them
+		if (batch.points.empty() && batch.lines.empty())
+		{
+			AddRectGeometry(batch);
+			batch.rects.clear();
+			continue;
+		}
+		FlushRectGeometry();
+#endif
+		SetColor(batch.color);
+		if (!batch.points.empty())
+		{
+			SDL_RenderDrawPoints(RenderData.renderer, batch.points.data(), static_cast<int>(batch.points.size()));
+		}
+		if (!batch.rects.empty())
+		{
+			SDL_RenderFillRects(RenderData.renderer, batch.rects.data(), static_cast<int>(batch.rects.size()));
+		}
+		stripStart = 0;
+		for (const size_t stripEnd : batch.lineStripEnds)
+		{
+			if (stripEnd - stripStart > 2)
+			{
+				SDL_RenderDrawLines(RenderData.renderer, &batch.lines[stripStart], static_cast<int>(stripEnd - stripStart));
+			}
+			stripStart = stripEnd;
+		}
+
+		batch.points.clear();
+		batch.rects.clear();
+		batch.lines.clear();
+		batch.lineStripEnds.clear();
+	}
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	FlushRectGeometry();
+#endif
+
+	usedBatchCount = 0;
+	lastBatchIndex = 0;
+}
+
 void DrawPoint(int posX, int posY, Color color)
 {
-	SetColor(color);
-	SDL_RenderDrawPoint(RenderData.renderer, posX, posY);	
+	GetDrawBatch(color).points.push_back(SDL_Point{ posX, posY });
 }
 
 void DrawLine(int startPosX, int startPosY, int endPosX, int endPosY, Color color)
 {
-	SetColor(color);
-	SDL_RenderDrawLine(RenderData.renderer, startPosX, startPosY, endPosX, endPosY);
+	DrawBatch& batch = GetDrawBatch(color);
+	if (startPosY == endPosY)
+	{
+		AddHorizontalLine(batch, startPosX, endPosX, startPosY);
+	}
+	else if (startPosX == endPosX)
+	{
+		batch.rects.push_back(SDL_Rect{ startPosX, std::min(startPosY, endPosY), 1, std::abs(endPosY - startPosY) + 1 });
+	}
+	else
+	{
+		if (batch.lines.empty() || batch.lines.back().x != startPosX || batch.lines.back().y != startPosY)
+		{
+			batch.lines.push_back(SDL_Point{ startPosX, startPosY });
+		}
+		else
+		{
+			batch.lineStripEnds.pop_back();
+		}
+		batch.lines.push_back(SDL_Point{ endPosX, endPosY });
+		batch.lineStripEnds.push_back(batch.lines.size());
+	}
 }
 
 void DrawRectangle(int posX, int posY, Color color)
 {
-	SetColor(color);
 	DrawPoint(posX, posY, color);
 }
 
 void DrawCircle(int x, int y, int radius, Color color)
 {
-	SetColor(color);
+	std::vector<SDL_Point>& points = GetDrawBatch(color).points;
     int offsetx, offsety, d;
 
     offsetx = 0;
@@ -40,14 +252,14 @@ void DrawCircle(int x, int y, int radius, Color color)
     d = radius -1;
 
     while (offsety >= offsetx) {
-        DrawPoint(x + offsetx, y + offsety, color);
-        DrawPoint(x + offsety, y + offsetx, color);
-        DrawPoint(x - offsetx, y + offsety, color);
-        DrawPoint(x - offsety, y + offsetx, color);
-        DrawPoint(x + offsetx, y - offsety, color);
-        DrawPoint(x + offsety, y - offsetx, color);
-        DrawPoint(x - offsetx, y - offsety, color);
-        DrawPoint(x - offsety, y - offsetx, color);
+        points.push_back(SDL_Point{ x + offsetx, y + offsety });
+        points.push_back(SDL_Point{ x + offsety, y + offsetx });
+        points.push_back(SDL_Point{ x - offsetx, y + offsety });
+        points.push_back(SDL_Point{ x - offsety, y + offsetx });
+        points.push_back(SDL_Point{ x + offsetx, y - offsety });
+        points.push_back(SDL_Point{ x + offsety, y - offsetx });
+        points.push_back(SDL_Point{ x - offsetx, y - offsety });
+        points.push_back(SDL_Point{ x - offsety, y - offsetx });
 
         if (d >= 2*offsetx) {
             d -= 2*offsetx + 1;
@@ -68,39 +280,32 @@ void DrawCircle(int x, int y, int radius, Color color)
 
 void DrawCircleFilled(int x, int y, int radius, Color color)
 {
-	SetColor(color);
-
-    int offsetx, offsety, d;
+	if (radius < 0)
+	{
+		return;
+	}
 
-    offsetx = 0;
-    offsety = radius;
-    d = radius -1;
+	DrawBatch& batch = GetDrawBatch(color);
 
-    while (offsety >= offsetx) {
+	// One rect per row, the midpoint walk visits most rows more than once
+	static std::vector<int32> halfWidths;
+	halfWidths.resize(std::max<size_t>(halfWidths.size(), radius + 1));
+	ComputeCircleHalfWidths(radius, halfWidths.data());
 
-        DrawLine(x - offsety, y + offsetx,
-                                     x + offsety, y + offsetx, color);
-        DrawLine(x - offsetx, y + offsety,
-                                     x + offsetx, y + offsety, color);
-        DrawLine(x - offsetx, y - offsety,
-                                     x + offsetx, y - offsety, color);
-        DrawLine(x - offsety, y - offsetx,
-                                     x + offsety, y - offsetx, color);
+	for (int row = 0; row <= radius; row++)
+	{
+		const int halfWidth = halfWidths[row];
+		if (halfWidth < 0)
+		{
+			continue;
+		}
 
-        if (d >= 2*offsetx) {
-            d -= 2*offsetx + 1;
-            offsetx +=1;
-        }
-        else if (d < 2 * (radius - offsety)) {
-            d += 2 * offsety - 1;
-            offsety -= 1;
-        }
-        else {
-            d += 2 * (offsety - offsetx - 1);
-            offsety -= 1;
-            offsetx += 1;
-        }
-    }
+		AddHorizontalLine(batch, x - halfWidth, x + halfWidth, y + row);
+		if (row != 0)
+		{
+			AddHorizontalLine(batch, x - halfWidth, x + halfWidth, y - row);
+		}
+	}
 }
 
 int GameEngine::Start()
@@ -127,6 +332,7 @@ int GameEngine::Start()
 
 	// We create a renderer with hardware acceleration, we also present according with the vertical sync refresh.
 	RenderData.renderer = SDL_CreateRenderer(RenderData.window, 0, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC) ;
+	bHasDrawColor = false;
 
 	bool quit = false;
 	SDL_Event event;
@@ -140,20 +346,8 @@ int GameEngine::Start()
 			}
 		}
 
-		// We clear what we draw before
-		SDL_RenderClear(RenderData.renderer);
-		// Set our color for the draw functions
-		SDL_SetRenderDrawColor(RenderData.renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-
-		// Now we can draw our point
 		float deltaTime = 0.16;
-		UpdateGame(deltaTime);
-		
-		// Set the color to what was before
-		SDL_SetRenderDrawColor(RenderData.renderer, 0x00, 0x00, 0x00, 0xFF);
-		// .. you could do some other drawing here
-		// And now we present everything we draw after the clear.
-		SDL_RenderPresent(RenderData.renderer);
+		RenderFrame(deltaTime);
 	}
 
 	SDL_DestroyWindow(RenderData.window);
@@ -161,5 +355,75 @@ int GameEngine::Start()
 	SDL_DestroyRenderer(RenderData.renderer);
 	SDL_Quit();
 
+	return EXIT_SUCCESS;
+}
+
+void GameEngine::RenderFrame(float deltaTime)
+{
+	// We clear what we draw before
+	SDL_RenderClear(RenderData.renderer);
+
+	// Now we can draw our point, everything gets submitted in a few batched calls afterwards
+	UpdateGame(deltaTime);
+	FlushDrawBatches();
+	
+	// Set the color to what was before, this is what the next frame gets cleared with
+	SetColor(Black);
+	// .. you could do some other drawing here
+	// And now we present everything we draw after the clear.
+	SDL_RenderPresent(RenderData.renderer);
+}
+
+int GameEngine::StartHeadless(const HeadlessSettings& settings)
+{
+	RenderData = {};
+	WindowData = {};
+
+	WindowData.width = 600;	
+	WindowData.height = 600;
+
+	// A software renderer on top of a plain surface needs no video driver, display or gpu
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, WindowData.width, WindowData.height, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (surface == NULL) {
+		std::cout << "Creating offscreen surface failed" << std::endl;
+		return 1;
+	}
+
+	RenderData.renderer = SDL_CreateSoftwareRenderer(surface);
+	if (RenderData.renderer == NULL) {
+		SDL_FreeSurface(surface);
+		return 2;
+	}
+	bHasDrawColor = false;
+
+	Initialize();
+
+	std::vector<unsigned int> framePixels(WindowData.width * WindowData.height);
+	std::chrono::duration<double, std::milli> frameTime {0};
+	for (int frame = 1; frame <= settings.frameCount; frame++) {
+		const auto frameStart = std::chrono::high_resolution_clock::now();
+		RenderFrame(settings.deltaTime);
+		frameTime += std::chrono::high_resolution_clock::now() - frameStart;
+
+		if (settings.ShouldDumpFrame(frame)) {
+			// Surface rows can be padded, copy them into a tightly packed buffer first
+			for (int y = 0; y < WindowData.height; y++) {
+				const unsigned int* row = reinterpret_cast<const unsigned int*>(static_cast<const char*>(surface->pixels) + y * surface->pitch);
+				std::copy(row, row + WindowData.width, framePixels.begin() + y * WindowData.width);
+			}
+
+			const std::string path = settings.GetFramePath(frame);
+			if (!WriteFrame(path, framePixels.data(), WindowData.width, WindowData.height)) {
+				std::cout << "Failed to write frame " << path << std::endl;
+			}
+		}
+	}
+
+	const double msPerFrame = settings.frameCount > 0 ? frameTime.count() / settings.frameCount : 0.0;
+	std::cout << "Frames: " << settings.frameCount << " - Frame ms: " << frameTime.count() << " - Ms/frame: " << msPerFrame << std::endl;
+
+	SDL_DestroyRenderer(RenderData.renderer);
+	SDL_FreeSurface(surface);
+
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -39,6 +39,7 @@ static const Color White =        MakeColor(255, 255, 255);
 
 struct SDL_Window;
 struct SDL_Renderer;
+struct HeadlessSettings;
 
 struct Renderer
 {
@@ -55,6 +56,9 @@ struct Window
 static Renderer RenderData;
 
 void SetColor(Color newColor);
+// Draw calls are batched per color and submitted at the end of the frame, call this to submit them earlier
+// when something has to be drawn on top of what was queued so far
+void FlushDrawBatches();
 void DrawPoint(int posX, int posY, Color color);
 void DrawLine(int startPosX, int startPosY, int endPosX, int endPosY, Color color);
 void DrawRectangle(int posX, int posY, Color color);
@@ -66,9 +70,14 @@ class GameEngine
 public:
 	GameEngine() {}
 	int Start(); 
+	// Renders into an offscreen software renderer instead of a window, see SHeadless.h
+	int StartHeadless(const HeadlessSettings& settings);
 
 	virtual void Initialize() {}
 	virtual void UpdateGame(float deltaTime) {}
 	
 	Window WindowData;
+
+private:
+	void RenderFrame(float deltaTime);
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "SDamage.h"
+
+#include <algorithm>
+
+DamageMask::DamageMask(int32 inWidth, int32 inHeight)
+	: width(inWidth)
+	, height(inHeight)
+	, tileCountX((inWidth + TileSize - 1) / TileSize)
+	, tileCountY((inHeight + TileSize - 1) / TileSize)
+	, wordsPerRow((tileCountX + 63) / 64)
+	, words(static_cast<size_t>(wordsPerRow * tileCountY), 0)
+{
+}
+
+// Bits [first, last] of a word, both in 0..63
+static uint64 GetBitRange(int32 first, int32 last)
+{
+	const uint64 upToLast = last == 63 ? ~0ull : (1ull << (last + 1)) - 1;
+	return upToLast & ~((1ull << first) - 1);
+}
+
+void DamageMask::Add(const DamageRect& rect)
+{
+	const DamageRect clipped = GetIntersection(rect, DamageRect { 0, 0, width, height });
+	if (clipped.IsEmpty())
+	{
+		return;
+	}
+
+	const int32 firstTileX = clipped.minX / TileSize;
+	const int32 lastTileX = (clipped.maxX - 1) / TileSize;
+	const int32 firstTileY = clipped.minY / TileSize;
+	const int32 lastTileY = (clipped.maxY - 1) / TileSize;
+	for (int32 word = firstTileX / 64; word <= lastTileX / 64; word++)
+	{
+		const uint64 bits = GetBitRange(std::max(firstTileX - word * 64, 0), std::min(lastTileX - word * 64, 63));
+		uint64* row = words.data() + firstTileY * wordsPerRow + word;
+		for (int32 tileY = firstTileY; tileY <= lastTileY; tileY++, row += wordsPerRow)
+		{
+			*row |= bits;
+		}
+	}
+}
+
+void DamageMask::Add(const DamageMask& other)
+{
+	for (size_t i = 0; i < words.size() && i < other.words.size(); i++)
+	{
+		words[i] |= other.words[i];
+	}
+}
+
+void DamageMask::AddAll()
+{
+	Add(DamageRect { 0, 0, width, height });
+}
+
+void DamageMask::Clear()
+{
+	std::fill(words.begin(), words.end(), 0);
+}
+
+bool DamageMask::IsEmpty() const
+{
+	return std::all_of(words.begin(), words.end(), [](uint64 word) { return word == 0; });
+}
+
+bool DamageMask::IsTileSet(int32 tileX, int32 tileY) const
+{
+	return ((words[tileY * wordsPerRow + tileX / 64] >> (tileX % 64)) & 1) != 0;
+}
+
+void DamageMask::GetRects(std::vector<DamageRect>& outRects) const
+{
+	// Rects of the previous row that can still grow downwards, as indices into outRects
+	std::vector<size_t> openRects;
+	std::vector<size_t> stillOpen;
+	for (int32 tileY = 0; tileY < tileCountY; tileY++)
+	{
+		const int32 minY = tileY * TileSize;
+		const int32 maxY = std::min(minY + TileSize, height);
+		stillOpen.clear();
+
+		for (int32 tileX = 0; tileX < tileCountX;)
+		{
+			if (!IsTileSet(tileX, tileY))
+			{
+				tileX++;
+				continue;
+			}
+			const int32 runStart = tileX;
+			while (tileX < tileCountX && IsTileSet(tileX, tileY))
+			{
+				tileX++;
+			}
+
+			const int32 minX = runStart * TileSize;
+			const int32 maxX = std::min(tileX * TileSize, width);
+			const auto above = std::find_if(openRects.begin(), openRects.end(), [&](size_t index)
+			{
+				return outRects[index].minX == minX && outRects[index].maxX == maxX;
+			});
+			if (above != openRects.end())
+			{
+				outRects[*above].maxY = maxY;
+				stillOpen.push_back(*above);
+			}
+			else
+			{
+				outRects.push_back(DamageRect { minX, minY, maxX, maxY });
+				stillOpen.push_back(outRects.size() - 1);
+			}
+		}
+		openRects.swap(stillOpen);
+	}
+}
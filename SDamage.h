@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <algorithm>
+#include <vector>
+
+// Framebuffer regions that changed, tracked as one bit per TileSize x TileSize tile. Marking a draw only ORs a bit
+// range into the rows it covers, so it costs a few instructions no matter how scattered the draws are.
+// GetRects turns the marked tiles back into rects: runs of tiles per row, merged with the rows below them while
+// they cover the same columns.
+
+struct DamageRect
+{
+	// [minX, maxX) x [minY, maxY)
+	int32 minX;
+	int32 minY;
+	int32 maxX;
+	int32 maxY;
+
+	bool IsEmpty() const { return minX >= maxX || minY >= maxY; }
+	int32 GetWidth() const { return maxX - minX; }
+	int32 GetHeight() const { return maxY - minY; }
+	int64 GetArea() const { return static_cast<int64>(GetWidth()) * GetHeight(); }
+};
+
+inline DamageRect GetUnion(const DamageRect& lhs, const DamageRect& rhs)
+{
+	return DamageRect { std::min(lhs.minX, rhs.minX), std::min(lhs.minY, rhs.minY), std::max(lhs.maxX, rhs.maxX), std::max(lhs.maxY, rhs.maxY) };
+}
+
+inline DamageRect GetIntersection(const DamageRect& lhs, const DamageRect& rhs)
+{
+	return DamageRect { std::max(lhs.minX, rhs.minX), std::max(lhs.minY, rhs.minY), std::min(lhs.maxX, rhs.maxX), std::min(lhs.maxY, rhs.maxY) };
+}
+
+class DamageMask
+{
+public:
+	static constexpr int32 TileSize = 8;
+
+	DamageMask(int32 inWidth, int32 inHeight);
+
+	// Parts outside the mask are ignored
+	void Add(const DamageRect& rect);
+	// Add for a single pixel that is known to be inside the mask, cheap enough to call per SetPixel
+	void AddPixel(int32 x, int32 y)
+	{
+		const int32 tileX = x / TileSize;
+		words[(y / TileSize) * wordsPerRow + tileX / 64] |= 1ull << (tileX % 64);
+	}
+	void Add(const DamageMask& other);
+	void AddAll();
+	void Clear();
+
+	bool IsEmpty() const;
+	// Appends the marked tiles as rects in pixels, clamped to the mask size
+	void GetRects(std::vector<DamageRect>& outRects) const;
+
+private:
+	bool IsTileSet(int32 tileX, int32 tileY) const;
+
+	int32 width;
+	int32 height;
+	int32 tileCountX;
+	int32 tileCountY;
+	int32 wordsPerRow;
+	std::vector<uint64> words;
+};
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <vector>
+
+// Small entity component system: generational entity handles, sparse-set component stores and object pools.
+// Components of one type live contiguously in a dense array, lookups by entity are two array reads.
+
+struct Entity
+{
+	static constexpr uint32 InvalidIndex = 0xFFFFFFFF;
+
+	uint32 index = InvalidIndex;
+	uint32 generation = 0;
+
+	bool IsValid() const { return index != InvalidIndex; }
+	bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Component without data for stores that only mark entities, e.g. every entity that is a bullet
+struct Tag
+{
+};
+
+class EntityRegistry
+{
+public:
+	Entity Create()
+	{
+		if (!freeIndices.empty())
+		{
+			const uint32 index = freeIndices.back();
+			freeIndices.pop_back();
+			return Entity { index, generations[index] };
+		}
+
+		generations.push_back(0);
+		return Entity { static_cast<uint32>(generations.size() - 1), 0 };
+	}
+
+	// Handles to a destroyed entity stay invalid, even after its index gets reused
+	void Destroy(Entity entity)
+	{
+		if (!IsAlive(entity))
+		{
+			return;
+		}
+		generations[entity.index]++;
+		freeIndices.push_back(entity.index);
+	}
+
+	bool IsAlive(Entity entity) const
+	{
+		return entity.index < generations.size() && generations[entity.index] == entity.generation;
+	}
+
+	void Clear()
+	{
+		// Bump every generation so handles from before the clear can never alias new entities
+		freeIndices.clear();
+		for (uint32 index = 0; index < generations.size(); index++)
+		{
+			generations[index]++;
+			freeIndices.push_back(index);
+		}
+		std::reverse(freeIndices.begin(), freeIndices.end());
+	}
+
+private:
+	std::vector<uint32> generations;
+	std::vector<uint32> freeIndices;
+};
+
+template<typename T>
+class ComponentStore
+{
+public:
+	T& Add(Entity entity, const T& component = T {})
+	{
+		if (entity.index >= sparse.size())
+		{
+			sparse.resize(entity.index + 1, Entity::InvalidIndex);
+		}
+
+		uint32& denseIndex = sparse[entity.index];
+		if (denseIndex != Entity::InvalidIndex)
+		{
+			// Overwrites whatever a previous owner of this index left behind
+			entities[denseIndex] = entity;
+			components[denseIndex] = component;
+			return components[denseIndex];
+		}
+
+		denseIndex = static_cast<uint32>(entities.size());
+		entities.push_back(entity);
+		components.push_back(component);
+		return components.back();
+	}
+
+	// Swaps the last component into the hole so the dense arrays stay packed
+	void Remove(Entity entity)
+	{
+		if (!Has(entity))
+		{
+			return;
+		}
+
+		const uint32 denseIndex = sparse[entity.index];
+		const uint32 lastIndex = static_cast<uint32>(entities.size() - 1);
+		if (denseIndex != lastIndex)
+		{
+			entities[denseIndex] = entities[lastIndex];
+			components[denseIndex] = std::move(components[lastIndex]);
+			sparse[entities[denseIndex].index] = denseIndex;
+		}
+
+		entities.pop_back();
+		components.pop_back();
+		sparse[entity.index] = Entity::InvalidIndex;
+	}
+
+	bool Has(Entity entity) const
+	{
+		if (entity.index >= sparse.size())
+		{
+			return false;
+		}
+		const uint32 denseIndex = sparse[entity.index];
+		return denseIndex != Entity::InvalidIndex && entities[denseIndex] == entity;
+	}
+
+	T* TryGet(Entity entity)
+	{
+		return Has(entity) ? &components[sparse[entity.index]] : nullptr;
+	}
+
+	const T* TryGet(Entity entity) const
+	{
+		return Has(entity) ? &components[sparse[entity.index]] : nullptr;
+	}
+
+	// Unlike std::map::operator[] a missing component is a bug, not a silent insert
+	T& Get(Entity entity)
+	{
+		assert(Has(entity));
+		return components[sparse[entity.index]];
+	}
+
+	const T& Get(Entity entity) const
+	{
+		assert(Has(entity));
+		return components[sparse[entity.index]];
+	}
+
+	void Clear()
+	{
+		for (const Entity& entity : entities)
+		{
+			sparse[entity.index] = Entity::InvalidIndex;
+		}
+		entities.clear();
+		components.clear();
+	}
+
+	size_t Size() const { return entities.size(); }
+	bool IsEmpty() const { return entities.empty(); }
+
+	// Dense arrays, entities[i] owns components[i]
+	const std::vector<Entity>& GetEntities() const { return entities; }
+	std::vector<T>& GetComponents() { return components; }
+	const std::vector<T>& GetComponents() const { return components; }
+
+	template<typename Func>
+	void ForEach(Func&& func)
+	{
+		for (size_t i = 0; i < entities.size(); i++)
+		{
+			func(entities[i], components[i]);
+		}
+	}
+
+private:
+	std::vector<uint32> sparse;
+	std::vector<Entity> entities;
+	std::vector<T> components;
+};
+
+// Storage for short lived entities that keep all of their data in one T, e.g. bullets. Handles work like Entity,
+// slots are recycled through a free list and the live objects stay packed in one array. Once the pool has grown to
+// its peak size, or was given it with Reserve, spawning and despawning never allocate.
+template<typename T>
+class ObjectPool
+{
+public:
+	void Reserve(size_t count)
+	{
+		slots.reserve(count);
+		freeSlots.reserve(count);
+		handles.reserve(count);
+		objects.reserve(count);
+	}
+
+	Entity Spawn(const T& object)
+	{
+		uint32 slotIndex;
+		if (!freeSlots.empty())
+		{
+			slotIndex = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<uint32>(slots.size());
+			slots.push_back(Slot {});
+			freeSlots.reserve(slots.capacity());
+		}
+
+		Slot& slot = slots[slotIndex];
+		slot.denseIndex = static_cast<uint32>(handles.size());
+		const Entity handle { slotIndex, slot.generation };
+		handles.push_back(handle);
+		objects.push_back(object);
+		return handle;
+	}
+
+	// Swaps the last object into the hole, handles that are already despawned are ignored
+	void Despawn(Entity handle)
+	{
+		if (!IsAlive(handle))
+		{
+			return;
+		}
+
+		Slot& slot = slots[handle.index];
+		const uint32 lastIndex = static_cast<uint32>(handles.size() - 1);
+		if (slot.denseIndex != lastIndex)
+		{
+			handles[slot.denseIndex] = handles[lastIndex];
+			objects[slot.denseIndex] = std::move(objects[lastIndex]);
+			slots[handles[slot.denseIndex].index].denseIndex = slot.denseIndex;
+		}
+
+		handles.pop_back();
+		objects.pop_back();
+		slot.denseIndex = Entity::InvalidIndex;
+		slot.generation++;
+		freeSlots.push_back(handle.index);
+	}
+
+	bool IsAlive(Entity handle) const
+	{
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation && slots[handle.index].denseIndex != Entity::InvalidIndex;
+	}
+
+	T* TryGet(Entity handle)
+	{
+		return IsAlive(handle) ? &objects[slots[handle.index].denseIndex] : nullptr;
+	}
+
+	T& Get(Entity handle)
+	{
+		assert(IsAlive(handle));
+		return objects[slots[handle.index].denseIndex];
+	}
+
+	const T& Get(Entity handle) const
+	{
+		assert(IsAlive(handle));
+		return objects[slots[handle.index].denseIndex];
+	}
+
+	// Keeps the memory, handles from before the clear stay invalid
+	void Clear()
+	{
+		for (const Entity& handle : handles)
+		{
+			slots[handle.index].denseIndex = Entity::InvalidIndex;
+			slots[handle.index].generation++;
+			freeSlots.push_back(handle.index);
+		}
+		handles.clear();
+		objects.clear();
+	}
+
+	size_t Size() const { return handles.size(); }
+	bool IsEmpty() const { return handles.empty(); }
+
+	// Dense arrays, handles[i] owns objects[i]
+	const std::vector<Entity>& GetHandles() const { return handles; }
+	std::vector<T>& GetObjects() { return objects; }
+	const std::vector<T>& GetObjects() const { return objects; }
+
+private:
+	struct Slot
+	{
+		uint32 generation = 0;
+		uint32 denseIndex = Entity::InvalidIndex;
+	};
+
+	std::vector<Slot> slots;
+	// Never holds more than slots, reserved to match so recycling a slot can't allocate
+	std::vector<uint32> freeSlots;
+	std::vector<Entity> handles;
+	std::vector<T> objects;
+};
+
+// Visits every entity that has a component in all of the given stores.
+// Iterates the dense array of the smallest store and looks the others up by entity.
+// Adding or removing components of the viewed stores while iterating is not allowed.
+template<typename... Ts>
+class View
+{
+public:
+	explicit View(ComponentStore<Ts>&... inStores)
+		: stores(inStores...)
+	{
+	}
+
+	template<typename Func>
+	void ForEach(Func&& func)
+	{
+		const std::vector<Entity>& smallest = GetSmallestEntities();
+		for (size_t i = 0; i < smallest.size(); i++)
+		{
+			const Entity entity = smallest[i];
+			if (HasAll(entity))
+			{
+				std::apply([&](ComponentStore<Ts>&... store) { func(entity, store.Get(entity)...); }, stores);
+			}
+		}
+	}
+
+private:
+	bool HasAll(Entity entity) const
+	{
+		return std::apply([&](const ComponentStore<Ts>&... store) { return (store.Has(entity) && ...); }, stores);
+	}
+
+	const std::vector<Entity>& GetSmallestEntities() const
+	{
+		const std::vector<Entity>* smallest = nullptr;
+		std::apply([&](const ComponentStore<Ts>&... store)
+		{
+			((smallest = (smallest == nullptr || store.Size() < smallest->size()) ? &store.GetEntities() : smallest), ...);
+		}, stores);
+		return *smallest;
+	}
+
+	std::tuple<ComponentStore<Ts>&...> stores;
+};
@@ -1,67 +1,252 @@
 #include "SEngine.h"
-
-#include <windowsx.h>
-
-// INCLUDES FOR GDIPLUS
-#include <objidl.h>
-#include <gdiplus.h>
-#pragma comment (lib,"Gdiplus.lib")
-// ~INCLUDES FOR GDIPLUS
-
-// INCLUDES FOR MIDI OUTPUT
-#include <mmeapi.h>
-#pragma comment(lib, "winmm.lib")
-// ~INCLUDES FOR MIDI OUTPUT
+#include "SPlatform.h"
+#include "SHeadless.h"
+#include "SDamage.h"
+#include "SProfiler.h"
+#include "SFrameScheduler.h"
+#include "SInput.h"
+#include "SRaster.h"
+#include "SReplay.h"
+#include "SSynth.h"
 
 #include <algorithm>
-#include <iostream>
-#include <thread>
+#include <atomic>
 #include <chrono>
-#include <deque>
+#include <cmath>
+#include <ctime>
 #include <iomanip>
+#include <iostream>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
 using namespace std::chrono;
 
-#define MAX_LOADSTRING 100
-#define StringToCString(path) StringToWString(path).c_str()
+alignas(32) static Color framebuffer[Width * Height];
+static const SRasterTarget framebufferTarget = MakeRasterTarget(framebuffer, Width, Height);
+
+// What the platform presented last, GetPresentRects trims the damage down to pixels that differ from it
+static vector<Color> presentedFrame;
+// Everything drawn since the last Clear, and what the Clears since the last present changed
+static DamageMask drawnSinceClear(Width, Height);
+static DamageMask clearDamage(Width, Height);
+static DamageMask presentDamage(Width, Height);
+static vector<DamageRect> damagedRects;
+static vector<DamageRect> presentRects;
+static Color lastClearColor = 0;
+static bool bHasCleared = false;
+static std::string applicationName = "SDraw Application";
 
-void Start();
-void Tick(float deltaTime);
+// TODO[rsmekens]: figure a way to create a better way to map this so we aren't reliant on win32 values
+static KeyboardState keyboard;
+int mouseX {-1}, mouseY {-1};
+static InputEventQueue inputEvents;
+// Events that didn't fit in a full queue and can't be lost: key ups as one bit per key, and the last mouse position
+// packed as MouseOverflowValid | y << 16 | x. Written by the platform thread, ApplyInputEvents takes them after the queue.
+static std::atomic<uint64> overflowKeyUps[4] = {};
+static std::atomic<uint64> overflowMouse { 0 };
+static constexpr uint64 MouseOverflowValid = 1ull << 32;
+// Oldest input applied since the last present, 0 when there is none
+static uint64 oldestUnpresentedInput = 0;
+// Input to present latency since the window title was last updated
+static double inputLatencyMsSum = 0.0;
+static int32 inputLatencyCount = 0;
+
+static PulseSynth synth;
+static FrameScheduler frameScheduler;
+
+// MakeRandomSeed walks on from the session seed, recordings store it and replays restore it
+static uint32 sessionSeed = static_cast<uint32>(std::time(nullptr));
+static uint64 randomSeedState = sessionSeed;
+static ReplayWriter replayWriter;
+static ReplayFrame recordedFrame;
+// Where FinishProfiling writes the trace, empty while not profiling
+static std::string profilePath;
+
+const Color* GetFramebuffer()
+{
+	return framebuffer;
+}
 
-static unique_ptr<Gdiplus::Bitmap> bitmap;
-static unique_ptr<Gdiplus::Graphics> graphics;
-static unique_ptr<Gdiplus::Bitmap> bitmapOther;
-static unique_ptr<Gdiplus::Graphics> graphicsOther;
-static std::string applicationName = "SDraw Application";
+SRasterTarget GetFramebufferTarget()
+{
+	return framebufferTarget;
+}
 
-struct MusicNote { uint8_t noteId; std::chrono::milliseconds duration; };
-static deque<MusicNote> musicQueue;
+void AddFramebufferDamage(int32 x, int32 y, int32 width, int32 height)
+{
+	drawnSinceClear.Add(DamageRect { x, y, x + width, y + height });
+}
 
-static unique_ptr<std::thread> musicThread;
+// Shrinks rect to the rows and columns that differ from the presented frame and copies those over
+static DamageRect TrimToChanges(const DamageRect& rect)
+{
+	DamageRect changed { rect.maxX, rect.maxY, rect.minX, rect.minY };
+	for (int32 y = rect.minY; y < rect.maxY; y++)
+	{
+		const Color* current = framebuffer + y * Width;
+		Color* presented = presentedFrame.data() + y * Width;
+		int32 first = rect.minX;
+		while (first < rect.maxX && current[first] == presented[first])
+		{
+			first++;
+		}
+		if (first == rect.maxX)
+		{
+			continue;
+		}
+		int32 last = rect.maxX - 1;
+		while (current[last] == presented[last])
+		{
+			last--;
+		}
 
-static bool bLockFrameRate = false;
-static uint32 maxFrameRate = 120;
+		std::copy(current + first, current + last + 1, presented + first);
+		changed = GetUnion(changed, DamageRect { first, y, last + 1, y + 1 });
+	}
+	return changed;
+}
 
-// TODO[rsmekens]: figure a way to create a better way to map this so we aren't reliant on win32 values
-static vector<char> inputBuffer;
-static vector<char> keysDown;
-int mouseX {-1}, mouseY {-1};
+const vector<DamageRect>& GetPresentRects()
+{
+	SPROFILE_SCOPE("GetPresentRects");
+	presentRects.clear();
+	if (presentedFrame.empty())
+	{
+		presentedFrame.assign(framebuffer, framebuffer + Width * Height);
+		presentRects.push_back(DamageRect { 0, 0, Width, Height });
+	}
+	else
+	{
+		// Whatever is drawn now either got drawn since the last Clear or was wiped by a Clear. Draws from before the
+		// last present that are still on screen get presented again, the compare drops them as unchanged.
+		presentDamage = clearDamage;
+		presentDamage.Add(drawnSinceClear);
+		damagedRects.clear();
+		presentDamage.GetRects(damagedRects);
+		for (const DamageRect& rect : damagedRects)
+		{
+			const DamageRect changed = TrimToChanges(rect);
+			if (!changed.IsEmpty())
+			{
+				presentRects.push_back(changed);
+			}
+		}
+	}
+	clearDamage.Clear();
+	return presentRects;
+}
+
+PulseSynth& GetSynth()
+{
+	return synth;
+}
+
+void PlayMidiNote(int noteId, int ms)
+{
+	if (noteId < 0 || ms < 0)
+	{
+		return;
+	}
 
-static bool temp = false;
+	// TODO[rsmekens]: figure out what this noteId conversion does exactly
+	// A full queue means the audio thread is seconds behind, dropping the note beats stalling the game
+	synth.QueueNote(MusicNote{uint8(uint8(noteId) & 0x7F), milliseconds(ms)});
+}
 
-// Forward declarations of functions included in this code module:
-LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
+// Nearest neighbour copy of the source rect of the image into the destination rect of the framebuffer
+static void BlitImage(const SRasterTarget& target, const SImage& image, const SRect& destRect, const SRect& srcRect, BlendMode mode = BlendMode::Alpha, uint8 flip = BlitFlipNone)
+{
+	SPROFILE_SCOPE("DrawImage");
+	const BlitSource source { image.pixels, image.width, image.height, image.GetPitch() };
+	BlitParams params;
+	params.destX = destRect.x;
+	params.destY = destRect.y;
+	params.destWidth = destRect.width;
+	params.destHeight = destRect.height;
+	params.srcX = srcRect.x;
+	params.srcY = srcRect.y;
+	params.srcWidth = srcRect.width;
+	params.srcHeight = srcRect.height;
+	params.mode = mode;
+	params.flip = flip;
+	Blit(target, source, params);
+}
 
-void Clear(Color c)
+// Blits into the whole framebuffer and records what it covered, rounded the same way Blit rounds
+static void BlitToFramebuffer(const SImage& image, const SRect& destRect, const SRect& srcRect, BlendMode mode = BlendMode::Alpha, uint8 flip = BlitFlipNone)
 {
-	if (graphics == nullptr)
+	BlitImage(framebufferTarget, image, destRect, srcRect, mode, flip);
+	const int32 minX = static_cast<int32>(std::round(destRect.x));
+	const int32 minY = static_cast<int32>(std::round(destRect.y));
+	AddFramebufferDamage(minX, minY, static_cast<int32>(std::round(destRect.x + destRect.width)) - minX, static_cast<int32>(std::round(destRect.y + destRect.height)) - minY);
+}
+
+// Moves a decoded png into the Color array SImage owns
+static void ToImage(const std::string& path, const DecodedPng& decoded, SImage& outImage)
+{
+	outImage = {};
+	outImage.assetPath = path;
+	if (decoded.pixels.empty())
 	{
 		return;
 	}
-	graphics->Clear(Gdiplus::Color(c));
+
+	outImage.pixels = new Color[decoded.pixels.size()];
+	std::copy(decoded.pixels.begin(), decoded.pixels.end(), outImage.pixels);
+	outImage.width = decoded.width;
+	outImage.height = decoded.height;
+}
+
+PngError SLoadImage(const std::string& path, SImage& outImage)
+{
+	DecodedPng decoded;
+	const PngError error = LoadPng(path, decoded);
+	ToImage(path, decoded, outImage);
+	return error;
+}
+
+std::vector<PngError> SLoadImages(const std::vector<std::string>& paths, std::vector<SImage>& outImages)
+{
+	SPROFILE_SCOPE("SLoadImages");
+
+	std::vector<DecodedPng> decoded;
+	const std::vector<PngError> errors = LoadPngs(paths, decoded);
+	outImages.resize(paths.size());
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		ToImage(paths[i], decoded[i], outImages[i]);
+	}
+	return errors;
+}
+
+void SFreeImage(SImage& image)
+{
+	delete[] image.pixels;
+	image.pixels = nullptr;
+	image.width = 0;
+	image.height = 0;
+	image.pitch = 0;
+}
+
+void Clear(Color c)
+{
+	SPROFILE_SCOPE("Clear");
+	FillSpan(framebuffer, Width * Height, c);
+
+	// Clearing to the same color only changes what got drawn on top of the last clear
+	if (bHasCleared && c == lastClearColor)
+	{
+		clearDamage.Add(drawnSinceClear);
+	}
+	else
+	{
+		clearDamage.AddAll();
+	}
+	drawnSinceClear.Clear();
+	lastClearColor = c;
+	bHasCleared = true;
 }
 
 void RenderGrid()
@@ -77,8 +262,12 @@ void SetPixel(Vector2D pos, Color c)
 
 void SetPixel(int x, int y, Color c)
 {
-	Gdiplus::SolidBrush solidBrush(c);
-	graphics->FillRectangle(&solidBrush, x, y, 1, 1);
+	if (x < 0 || y < 0 || x >= Width || y >= Height)
+	{
+		return;
+	}
+	framebuffer[y * Width + x] = c;
+	drawnSinceClear.AddPixel(x, y);
 }
 
 void DrawFilledRectangle(Vector2D pos, Vector2D size, Color c)
@@ -88,8 +277,33 @@ void DrawFilledRectangle(Vector2D pos, Vector2D size, Color c)
 
 void DrawFilledRectangle(int32 x, int32 y, int32 width, int32 height, Color c)
 {
-	Gdiplus::SolidBrush solidBrush(c);
-	graphics->FillRectangle(&solidBrush, x, y, width, height);
+	SPROFILE_SCOPE("DrawFilledRectangle");
+	FillRect(framebufferTarget, x, y, width, height, c);
+	AddFramebufferDamage(x, y, width, height);
+}
+
+void DrawFilledCircle(Vector2D center, float radius, Color c)
+{
+	DrawFilledCircle(static_cast<int32>(std::round(center.x)), static_cast<int32>(std::round(center.y)), static_cast<int32>(std::round(radius)), c);
+}
+
+void DrawFilledCircle(int32 centerX, int32 centerY, int32 radius, Color c)
+{
+	SPROFILE_SCOPE("DrawFilledCircle");
+	FillCircle(framebufferTarget, centerX, centerY, radius, c);
+	AddFramebufferDamage(centerX - radius, centerY - radius, radius * 2 + 1, radius * 2 + 1);
+}
+
+void DrawFilledEllipse(Vector2D center, Vector2D radius, Color c)
+{
+	DrawFilledEllipse(static_cast<int32>(std::round(center.x)), static_cast<int32>(std::round(center.y)), static_cast<int32>(std::round(radius.x)), static_cast<int32>(std::round(radius.y)), c);
+}
+
+void DrawFilledEllipse(int32 centerX, int32 centerY, int32 radiusX, int32 radiusY, Color c)
+{
+	SPROFILE_SCOPE("DrawFilledEllipse");
+	FillEllipse(framebufferTarget, centerX, centerY, radiusX, radiusY, c);
+	AddFramebufferDamage(centerX - radiusX, centerY - radiusY, radiusX * 2 + 1, radiusY * 2 + 1);
 }
 
 void DrawRectangle(Vector2D pos, Vector2D size, Color c)
@@ -99,14 +313,43 @@ void DrawRectangle(Vector2D pos, Vector2D size, Color c)
 
 void DrawRectangle(int32 x, int32 y, int32 width, int32 height, Color c)
 {
-	Gdiplus::Pen solidPen(c);
-	graphics->DrawRectangle(&solidPen, x, y, width, height);
+	SPROFILE_SCOPE("DrawRectangle");
+	if (width < 0 || height < 0)
+	{
+		return;
+	}
+
+	// Outline covers x..x + width and y..y + height inclusive, same as a 1 pixel GDI+ pen
+	DrawFilledRectangle(x, y, width + 1, 1, c);
+	DrawFilledRectangle(x, y + height, width + 1, 1, c);
+	DrawFilledRectangle(x, y + 1, 1, height - 1, c);
+	DrawFilledRectangle(x + width, y + 1, 1, height - 1, c);
 }
 
 void DrawLine(int32 startX, int32 startY, int32 endX, int32 endY, Color c)
 {
-	Gdiplus::Pen pen(c);
-	graphics->DrawLine(&pen, startX, startY, endX, endY);
+	SPROFILE_SCOPE("DrawLine");
+	DrawLine(framebufferTarget, startX, startY, endX, endY, c);
+	AddFramebufferDamage(std::min(startX, endX), std::min(startY, endY), std::abs(endX - startX) + 1, std::abs(endY - startY) + 1);
+}
+
+void DrawPolyline(const std::vector<RasterPoint>& points, Color c)
+{
+	SPROFILE_SCOPE("DrawPolyline");
+	if (points.empty())
+	{
+		return;
+	}
+
+	DrawPolyline(framebufferTarget, points.data(), static_cast<int32>(points.size()), c);
+	// Per segment, a curve across the screen only damages the tiles along it
+	AddFramebufferDamage(points[0].x, points[0].y, 1, 1);
+	for (size_t i = 1; i < points.size(); i++)
+	{
+		const RasterPoint& start = points[i - 1];
+		const RasterPoint& end = points[i];
+		AddFramebufferDamage(std::min(start.x, end.x), std::min(start.y, end.y), std::abs(end.x - start.x) + 1, std::abs(end.y - start.y) + 1);
+	}
 }
 
 void DrawImage(const SImage& image, Vector2D position)
@@ -118,47 +361,58 @@ void DrawImage(const SImage& image, int32 startX, int32 startY, int32 width, int
 {
 	const int32 drawWidth = width == -1 ? image.width : width;
 	const int32 drawHeight = height == -1 ? image.height : height;
-	graphics->DrawImage((Gdiplus::Bitmap*)image.bitmap, startX, startY, drawWidth, drawHeight);	
+	const SRect destRect { Cast<float>(startX), Cast<float>(startY), Cast<float>(drawWidth), Cast<float>(drawHeight) };
+	const SRect srcRect { 0.f, 0.f, Cast<float>(image.width), Cast<float>(image.height) };
+	BlitToFramebuffer(image, destRect, srcRect);
 }
 
 void DrawImage(const SImage& image, const SRect& inDestRect, const SRect& inSrcRect)
 {
-	Gdiplus::RectF destRect { inDestRect.x, inDestRect.y, inDestRect.width, inDestRect.height };
-	Gdiplus::RectF srcRect { inSrcRect.x, inSrcRect.y, inSrcRect.width, inSrcRect.height };
-	graphics->DrawImage((Gdiplus::Bitmap*)image.bitmap, destRect, srcRect.X, srcRect.Y, srcRect.Width, srcRect.Height, Gdiplus::UnitPixel);
+	BlitToFramebuffer(image, inDestRect, inSrcRect);
+}
+
+void DrawImage(const SImage& image, const SRect& inDestRect, const SRect& inSrcRect, BlendMode mode, uint8 flip)
+{
+	BlitToFramebuffer(image, inDestRect, inSrcRect, mode, flip);
+}
+
+void DrawImage(const SRasterTarget& target, const SImage& image, const SRect& inDestRect, const SRect& inSrcRect, BlendMode mode, uint8 flip)
+{
+	BlitImage(target, image, inDestRect, inSrcRect, mode, flip);
 }
 
 void DrawSprite(const SSprite& sprite, const Vector2D& position)
 {
-	Gdiplus::RectF destRect { position.x, position.y, sprite.cellSizeX, static_cast<float>(sprite.srcImage.height)};
-	Gdiplus::RectF srcRect { sprite.cellSizeX * sprite.index, 0, sprite.cellSizeX, static_cast<float>(sprite.srcImage.height) };
-	graphics->DrawImage((Gdiplus::Bitmap*)sprite.srcImage.bitmap, destRect, srcRect.X, srcRect.Y, srcRect.Width, srcRect.Height, Gdiplus::UnitPixel);	
+	const SRect destRect { position.x, position.y, sprite.cellSizeX, static_cast<float>(sprite.srcImage.height)};
+	const SRect srcRect { sprite.cellSizeX * sprite.index, 0, sprite.cellSizeX, static_cast<float>(sprite.srcImage.height) };
+	BlitToFramebuffer(sprite.srcImage, destRect, srcRect);
 }
 
 void DrawSprite(const SSprite& sprite, const Vector2D& position, const Vector2D& scale)
 {
-	Gdiplus::RectF destRect { position.x, position.y, sprite.cellSizeX * scale.x, static_cast<float>(sprite.srcImage.height * scale.y)};
-	Gdiplus::RectF srcRect { sprite.cellSizeX * sprite.index, 0, sprite.cellSizeX, static_cast<float>(sprite.srcImage.height) };
-	graphics->DrawImage((Gdiplus::Bitmap*)sprite.srcImage.bitmap, destRect, srcRect.X, srcRect.Y, srcRect.Width, srcRect.Height, Gdiplus::UnitPixel);	
+	const SRect destRect { position.x, position.y, sprite.cellSizeX * scale.x, static_cast<float>(sprite.srcImage.height * scale.y)};
+	const SRect srcRect { sprite.cellSizeX * sprite.index, 0, sprite.cellSizeX, static_cast<float>(sprite.srcImage.height) };
+	BlitToFramebuffer(sprite.srcImage, destRect, srcRect);
 }
 
 void DrawSprite(const SImage& image, const SRect& inDestRect, const SRect& inSrcRect)
 {
-	Gdiplus::RectF destRect { inDestRect.x, inDestRect.y, inDestRect.width, inDestRect.height };
-	Gdiplus::RectF srcRect { inSrcRect.x, inSrcRect.y, inSrcRect.width, inSrcRect.height };
-	graphics->DrawImage((Gdiplus::Bitmap*)image.bitmap, destRect, srcRect.X, srcRect.Y, srcRect.Width, srcRect.Height, Gdiplus::UnitPixel);		
+	BlitToFramebuffer(image, inDestRect, inSrcRect);
 }
 
 bool IsKeyDown(char key)
 {
-	for (const char& curKey : keysDown)
-	{
-		if(key == curKey)
-		{
-			return true;
-		}
-	}
-	return false;
+	return keyboard.down.Test(static_cast<uint8>(key));
+}
+
+bool WasKeyPressed(char key)
+{
+	return keyboard.pressed.Test(static_cast<uint8>(key));
+}
+
+bool WasKeyReleased(char key)
+{
+	return keyboard.released.Test(static_cast<uint8>(key));
 }
 
 int GetMouseX()
@@ -171,250 +425,346 @@ int GetMouseY()
 	return mouseY;
 }
 
-void SetApplicationName(const std::string& newApplicationName)
+void SetMousePosition(int32 x, int32 y)
 {
-	applicationName = newApplicationName;
+	mouseX = x;
+	mouseY = y;
 }
 
-void AddKeyDown(char key)
+void PushInputEvent(const InputEvent& event)
 {
-	if (!IsKeyDown(key))
+	const uint64 keyBit = 1ull << (event.key & 63);
+	if (event.type == InputEventType::KeyDown)
+	{
+		// A key that goes down again isn't released anymore by a key up that overflowed before
+		overflowKeyUps[event.key >> 6].fetch_and(~keyBit);
+	}
+
+	if (inputEvents.Push(event))
+	{
+		return;
+	}
+
+	// A full queue means nobody is ticking, don't block the platform on it. Presses can be dropped, but a dropped
+	// key up would leave the key stuck down, and a move only matters for where the mouse ends up.
+	switch (event.type)
 	{
-		keysDown.push_back(key);
+	case InputEventType::KeyDown:
+		break;
+	case InputEventType::KeyUp:
+		overflowKeyUps[event.key >> 6].fetch_or(keyBit);
+		break;
+	case InputEventType::MouseMove:
+		overflowMouse.store(MouseOverflowValid | (static_cast<uint64>(static_cast<uint16>(event.mouseY)) << 16) | static_cast<uint16>(event.mouseX));
+		break;
 	}
 }
 
-void RemoveKeyDown(char key)
+static void ApplyInputEvents()
 {
-	for (int i = 0; i < keysDown.size(); i++)
+	InputEvent event;
+	while (inputEvents.Pop(event))
 	{
-		if(key == keysDown[i])
+		switch (event.type)
+		{
+		case InputEventType::KeyDown:
+			keyboard.Press(event.key);
+			break;
+		case InputEventType::KeyUp:
+			keyboard.Release(event.key);
+			break;
+		case InputEventType::MouseMove:
+			SetMousePosition(event.mouseX, event.mouseY);
+			break;
+		}
+		if (oldestUnpresentedInput == 0)
 		{
-			keysDown.erase(keysDown.begin() + i);
-			return;
+			oldestUnpresentedInput = event.timestamp;
 		}
 	}
-}
 
-void PlayMidiNote(int noteId, int ms)
-{
-	if (noteId < 0)
+	// Everything that overflowed happened after the events that were in the queue at the time
+	for (uint32 word = 0; word < 4; word++)
 	{
-		return;
+		uint64 keyUps = overflowKeyUps[word].exchange(0);
+		for (uint32 bit = 0; keyUps != 0; bit++, keyUps >>= 1)
+		{
+			if (keyUps & 1)
+			{
+				keyboard.Release(static_cast<uint8>(word * 64 + bit));
+			}
+		}
 	}
-	
-	if (ms < 0)
+	const uint64 mouse = overflowMouse.exchange(0);
+	if (mouse & MouseOverflowValid)
 	{
-		return;
+		SetMousePosition(static_cast<int16>(mouse & 0xFFFF), static_cast<int16>((mouse >> 16) & 0xFFFF));
 	}
-	
-	// TODO[rsmekens]: figure out what this noteId conversion does exactly
-	musicQueue.push_back(MusicNote{uint8(uint8(noteId) & 0x7F), milliseconds(ms)});
 }
 
-void MusicTick()
+void MarkFramePresented()
 {
-	HMIDIOUT synth = nullptr;
-	if (midiOutOpen(&synth, MIDI_MAPPER, 0, 0, CALLBACK_NULL) != MMSYSERR_NOERROR )
+	if (oldestUnpresentedInput != 0)
 	{
-		return;
+		inputLatencyMsSum += static_cast<double>(GetInputTimestamp() - oldestUnpresentedInput) / 1000000.0;
+		inputLatencyCount++;
+		oldestUnpresentedInput = 0;
 	}
+}
 
-	// We always use the "Lead 1 (Square)" instrument because it sounds like the PC speaker
-	constexpr uint8_t Instrument = 80;
-	midiOutShortMsg(synth, 0xC0 | (Instrument << 8));
-	
-	while(true)
-	{
-		MusicNote n;
-		{
-			if (musicQueue.empty())
-			{
-				this_thread::sleep_for(1ms);
-				continue;
-			}
-			
-			n = musicQueue.front();
-			musicQueue.pop_front();
-		}
+void SetApplicationName(const std::string& newApplicationName)
+{
+	applicationName = newApplicationName;
+}
 
-		if (n.noteId != 0)
-		{
-			midiOutShortMsg(synth, 0x00700090 | (n.noteId << 8));
-		}
-		this_thread::sleep_for(n.duration);
-		if (n.noteId != 0)
-		{
-			midiOutShortMsg(synth, 0x00000090 | (n.noteId << 8));
-		}
+const std::string& GetApplicationName()
+{
+	return applicationName;
+}
+
+std::string MakeWindowTitle(float frameMs, float inputLatencyMs)
+{
+	const float fps = (1.0f / frameMs) * 1000.0f;
+	std::stringstream stream;
+	stream << applicationName;
+	stream << std::fixed << std::setprecision(3) << " | Ms: " << frameMs;
+	stream << std::fixed << std::setprecision(2) << " - FPS: " << fps;
+	stream << std::fixed << std::setprecision(3) << " - Delta: " << frameMs / 1000.0f;
+	if (inputLatencyMs >= 0.f)
+	{
+		stream << std::fixed << std::setprecision(2) << " - Input ms: " << inputLatencyMs;
 	}
+	return stream.str();
+}
 
-	midiOutClose(synth);
+void SetTargetFrameRate(float framesPerSecond)
+{
+	frameScheduler.SetTargetFrameRate(framesPerSecond);
 }
 
+float GetTargetFrameRate()
+{
+	return frameScheduler.GetTargetFrameRate();
+}
 
-int APIENTRY wWinMain(HINSTANCE hInstance,
-					  HINSTANCE hPrevInstance,
-					  LPWSTR    lpCmdLine,
-					  int nCmdShow)
+void SetFixedTimeStep(float seconds)
 {
-	WNDCLASS windowClass = {}; // reserves memory on the stack but set's everything to zero
-	// https://docs.microsoft.com/en-us/windows/win32/winmsg/window-class-styles
-	windowClass.style = CS_HREDRAW | CS_VREDRAW;
-	// Flags that decide that we need to repaint the whole window  (otherwise will only repaint the resize section)
-	windowClass.lpfnWndProc = WndProc;
-	windowClass.hInstance = hInstance;
-	//windowClass.hIcon;
-	windowClass.lpszClassName = L"PONG";
-	if (!RegisterClass(&windowClass)) return 1;
+	frameScheduler.SetFixedTimeStep(seconds);
+}
 
-	const DWORD style = WS_OVERLAPPED | WS_SYSMENU | WS_CAPTION;
-	
-	RECT r{ 0, 0, Width * PixelScale, Height * PixelScale};
-	AdjustWindowRect(&r, style, FALSE);
-	
-	//HWND wnd = CreateWindowEx(0, wdc, style, CW_USEDEFAULT, CW_USEDEFAULT, r.right - r.left, r.bottom - r.top, nullptr, nullptr, hInstance, nullptr);
-	HWND window = CreateWindowEx(0, windowClass.lpszClassName, L"Window Name - SDRAW",
-									WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT,
-									r.right - r.left, r.bottom - r.top, 0, 0, hInstance, 0);
-	if (window == nullptr) return 1;
-
-	// Initialize GDI+.
-	ULONG_PTR gdiplusToken;
-	Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-	Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
-
-	bitmap = make_unique<Gdiplus::Bitmap>(Width, Height);
-	graphics = make_unique<Gdiplus::Graphics>(bitmap.get());
-	bitmapOther = make_unique<Gdiplus::Bitmap>(Width, Height);
-	graphicsOther = make_unique<Gdiplus::Graphics>(bitmapOther.get());
+float GetFrameInterpolation()
+{
+	return frameScheduler.GetInterpolation();
+}
 
-	Clear(Blue);
-	// ~Initialize GDI+.
+uint32 MakeRandomSeed()
+{
+	// splitmix64, consecutive seeds look nothing alike even though the state only counts up
+	randomSeedState += 0x9E3779B97F4A7C15ull;
+	uint64 value = randomSeedState;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return static_cast<uint32>(value ^ (value >> 31));
+}
 
-	// START MUSIC FUNCTIONALITY
-	musicThread = make_unique<std::thread>(MusicTick);
-	musicThread->detach();
-	// ~START MUSIC FUNCTIONALITY
+static void SetSessionSeed(uint32 seed)
+{
+	sessionSeed = seed;
+	randomSeedState = seed;
+}
 
-	ShowWindow(window, nCmdShow);
-	UpdateWindow(window);
+bool StartRecording(const std::string& path)
+{
+	// Seeds handed out before the recording started can't be replayed
+	SetSessionSeed(sessionSeed);
+	return replayWriter.Open(path, sessionSeed);
+}
 
-	Start();
+// Every Tick goes through here, so a recording sees the same deltas and input the game got
+static void TickGame(float deltaTime)
+{
+	if (replayWriter.IsOpen())
+	{
+		recordedFrame.deltaTime = deltaTime;
+		keyboard.down.GetKeys(recordedFrame.keysDown);
+		keyboard.pressed.GetKeys(recordedFrame.keysPressed);
+		keyboard.released.GetKeys(recordedFrame.keysReleased);
+		recordedFrame.mouseX = mouseX;
+		recordedFrame.mouseY = mouseY;
+	}
+
+	{
+		SPROFILE_SCOPE("Tick");
+		Tick(deltaTime);
+	}
+	// Presses and releases are only reported to the first tick after them
+	keyboard.ClearEdges();
+
+	if (replayWriter.IsOpen())
+	{
+		recordedFrame.checksum = HashPixels(framebuffer, Width * Height);
+		replayWriter.Write(recordedFrame);
+	}
+}
+
+bool RunFrame(std::string& outTitle)
+{
+	const float frameTime = frameScheduler.WaitForNextFrame();
+	ApplyInputEvents();
 
-	auto lastDraw = high_resolution_clock::now();
-	MSG message;
-	while (true)
+	if (frameScheduler.GetFixedTimeStep() > 0.f)
 	{
-		if (PeekMessage(&message, nullptr, 0, 0, PM_REMOVE))
+		const int32 steps = frameScheduler.ConsumeFixedSteps(frameTime);
+		for (int32 step = 0; step < steps; step++)
 		{
-			if (message.message == WM_QUIT) break;
-			TranslateMessage(&message);
-			DispatchMessage(&message);
+			TickGame(frameScheduler.GetFixedTimeStep());
 		}
+	}
+	else
+	{
+		TickGame(frameTime);
+	}
 
-		auto now = high_resolution_clock::now();
-		duration<float, std::milli> f_millis = now - lastDraw; 
-		auto f_secs = std::chrono::duration_cast<duration<float>>(f_millis);
-		auto fps = (1.0f / (float)f_millis.count()) * 1000.0f;
+	float averageFrameMs = 0.f;
+	if (frameScheduler.ConsumeStatsUpdate(averageFrameMs))
+	{
+		const float inputLatencyMs = inputLatencyCount > 0 ? static_cast<float>(inputLatencyMsSum / inputLatencyCount) : -1.f;
+		inputLatencyMsSum = 0.0;
+		inputLatencyCount = 0;
+		outTitle = MakeWindowTitle(averageFrameMs, inputLatencyMs);
+		return true;
+	}
+	return false;
+}
 
-		
-		// std::cout << "Milli: " << i_millis.count() << '\n';
-		// std::cout << "Sec: " << f_secs.count() << '\n';
-		// std::cout << "FPS: " << fps << '\n';
+void StartProfiling(const std::string& path)
+{
+	profilePath = path;
+	SetProfilerEnabled(!profilePath.empty());
+}
 
-		float targetMs = (1.0f / static_cast<float>(maxFrameRate) * 1000);
-		if (bLockFrameRate && f_millis < duration<double, milli>(targetMs))
-		{
-			continue;	
-		}else
-		{
-			std::stringstream stream;
-			stream << applicationName;
-			stream << std::fixed << std::setprecision(3) << " | Ms: " << f_millis.count();
-			stream << std::fixed << std::setprecision(2) << " - FPS: " << fps;
-			stream << std::fixed << std::setprecision(3) << " - Delta: " << f_secs.count();
-			const std::string appName = stream.str(); 
-			SetWindowText(window, StringToCString(appName));
-
-			temp = !temp;
-			Tick(f_secs.count());
-			InvalidateRect(window, nullptr, false);
-	
-			inputBuffer.clear();
+void FinishProfiling()
+{
+	if (!IsProfilerEnabled())
+	{
+		return;
+	}
 
-			lastDraw = now;	
-		}
+	SetProfilerEnabled(false);
+	if (!ExportProfilerTrace(profilePath))
+	{
+		std::cout << "Failed to write profile " << profilePath << std::endl;
 	}
-	
-	bitmap.reset();
-	graphics.reset();
-	bitmapOther.reset();
-	graphicsOther.reset();
-	Gdiplus::GdiplusShutdown(gdiplusToken);
-	
-	return (int) message.wParam;
+	profilePath.clear();
 }
 
-LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+int RunHeadless(const HeadlessSettings& settings)
 {
-	static HDC bitmapDC{};
-	static HBITMAP hbitmap{};
-	
-	switch (message)
+	StartProfiling(settings.profilePath);
+
+	ReplayLog replay;
+	const bool bReplay = !settings.replayPath.empty();
+	if (bReplay)
 	{
-	case WM_PAINT:
+		if (!LoadReplay(settings.replayPath, replay))
 		{
-			PAINTSTRUCT ps;
-			HDC hdc = BeginPaint(hWnd, &ps);
+			std::cout << "Failed to load replay " << settings.replayPath << std::endl;
+			return 1;
+		}
+		SetSessionSeed(replay.seed);
+	}
+	if (!settings.recordPath.empty() && !StartRecording(settings.recordPath))
+	{
+		std::cout << "Failed to open recording " << settings.recordPath << std::endl;
+	}
+	const int32 frameCount = bReplay ? static_cast<int32>(replay.frames.size()) : settings.frameCount;
+	// First frame that drew something else than the recording did, 0 while they match
+	int32 firstDifferentFrame = 0;
 
-			if (!hbitmap)
-			{
-				bitmapDC = CreateCompatibleDC(hdc);
-				hbitmap = CreateCompatibleBitmap(hdc, Width, Height);
-			}
+	Clear(Blue);
 
-			HANDLE old = SelectObject(bitmapDC, hbitmap);
-			{
-				Gdiplus::Graphics hdcG(bitmapDC);
-				hdcG.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
-				hdcG.DrawImage(bitmap.get(), 0, 0, 0, 0, Width, Height, Gdiplus::UnitPixel);
-			}
+	Start();
 
-			StretchBlt(hdc, 0, 0, Width * PixelScale, Height * PixelScale, bitmapDC, 0, 0, Width, Height, SRCCOPY);
-			SelectObject(bitmapDC, old);
+	WavFileSink audioSink;
+	if (!settings.audioPath.empty() && !audioSink.Open(settings.audioPath, PulseSynth::SampleRate))
+	{
+		std::cout << "Failed to open audio file " << settings.audioPath << std::endl;
+	}
+	// Audio is rendered up to the simulated time after every tick, so notes land on the same samples every run
+	uint64 audioSamples = 0;
+	vector<int16> audioBuffer;
+	double simulatedSeconds = 0.0;
 
-			EndPaint(hWnd, &ps);
+	duration<double, std::milli> tickTime {0};
+	for (int32 frame = 1; frame <= frameCount; frame++)
+	{
+		float deltaTime = settings.deltaTime;
+		if (bReplay)
+		{
+			// The input the platform reported before this tick was recorded
+			const ReplayFrame& replayFrame = replay.frames[frame - 1];
+			deltaTime = replayFrame.deltaTime;
+			keyboard.down.SetKeys(replayFrame.keysDown);
+			keyboard.pressed.SetKeys(replayFrame.keysPressed);
+			keyboard.released.SetKeys(replayFrame.keysReleased);
+			SetMousePosition(replayFrame.mouseX, replayFrame.mouseY);
 		}
-		break;
-	case WM_KEYDOWN:
-		AddKeyDown(static_cast<char>(wParam));
-		if (wParam == VK_UP)
+
+		const auto tickStart = high_resolution_clock::now();
+		TickGame(deltaTime);
+		tickTime += high_resolution_clock::now() - tickStart;
+		simulatedSeconds += deltaTime;
+
+		if (bReplay && firstDifferentFrame == 0 && HashPixels(framebuffer, Width * Height) != replay.frames[frame - 1].checksum)
 		{
-			//std::cout << "Pressed UP arrow key" << std::endl;	
+			firstDifferentFrame = frame;
 		}
-		
-		if (wParam == VK_ESCAPE)
+
+		if (audioSink.IsOpen())
 		{
-			// TODO[rsmekens]: quit application
+			const uint64 targetSamples = static_cast<uint64>(std::llround(simulatedSeconds * PulseSynth::SampleRate));
+			const uint32 sampleCount = static_cast<uint32>(targetSamples - std::min(audioSamples, targetSamples));
+			audioBuffer.resize(sampleCount);
+			synth.ReadSamples(audioBuffer.data(), sampleCount);
+			audioSink.Write(audioBuffer.data(), sampleCount);
+			audioSamples += sampleCount;
 		}
-		break;
-	case WM_MOUSEMOVE:
-		mouseX = GET_X_LPARAM(lParam) / PixelScale;
-		mouseY = GET_Y_LPARAM(lParam) / PixelScale;
-		break;	
-	case WM_KEYUP:
-		RemoveKeyDown(static_cast<char>(wParam));	
-		break;
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		break;
-	default:
-		return DefWindowProc(hWnd, message, wParam, lParam);
+
+		if (settings.ShouldDumpFrame(frame))
+		{
+			const std::string path = settings.GetFramePath(frame);
+			if (!WriteFrame(path, framebuffer, Width, Height))
+			{
+				std::cout << "Failed to write frame " << path << std::endl;
+			}
+		}
+	}
+
+	FinishProfiling();
+	replayWriter.Close();
+
+	const double msPerFrame = frameCount > 0 ? tickTime.count() / frameCount : 0.0;
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << applicationName << " | Frames: " << frameCount << " - Tick ms: " << tickTime.count();
+	std::cout << " - Ms/frame: " << msPerFrame << " - FPS: " << (msPerFrame > 0.0 ? 1000.0 / msPerFrame : 0.0) << std::endl;
+	if (firstDifferentFrame != 0)
+	{
+		std::cout << "Replay differs from the recording from frame " << firstDifferentFrame << " on" << std::endl;
+		return 1;
 	}
 	return 0;
 }
 
+void AddKeyDown(char key)
+{
+	keyboard.Press(static_cast<uint8>(key));
+}
+
+void RemoveKeyDown(char key)
+{
+	keyboard.Release(static_cast<uint8>(key));
+}
+
 // This block of numbers encodes a monochrome, 5-pixel-tall font for the first 127 ASCII characters!
 //
 // Bits are shifted out one at a time as each row is drawn (top to bottom).  Because each glyph fits
@@ -433,36 +783,144 @@ static const unsigned int Font[128] = {
 	0x300008BF, 0x400F662E, 0x300068BF, 0x300026B2, 0x300007E1, 0x30007E1F, 0x30003E0F, 0x50F8320F, 0x30006C9B, 0x30000F83, 0x30004EB9, 0x30004764, 0x1000001F, 0x30001371, 0x50441044, 0x00000000,
 };
 
-int32 DrawCharacter(int32 left, int32 top, char charToDraw, Color color, int32 size)
+static uint32 GetGlyph(char c)
 {
-	unsigned int glyph = Font[charToDraw];
-	int width = glyph >> 28;
+	// Only the first 128 ASCII characters have a glyph
+	return (c & 0x80) ? 0 : Font[static_cast<int32>(c)];
+}
+
+// A horizontal run of lit pixels, relative to the origin of the glyph or text run it belongs to
+struct GlyphSpan
+{
+	int16 x;
+	int16 y;
+	int16 length;
+};
+
+// Every glyph pre-expanded into spans for one text size, glyph c owns spans [firstSpan[c], firstSpan[c + 1])
+struct GlyphAtlas
+{
+	std::vector<GlyphSpan> spans;
+	int32 firstSpan[129];
+};
+
+// Rasterized spans of a whole string, merged across glyphs and sorted top to bottom
+struct TextRun
+{
+	std::vector<GlyphSpan> spans;
+};
+
+struct TextRunKey
+{
+	std::string text;
+	int32 size;
+
+	bool operator==(const TextRunKey& other) const { return size == other.size && text == other.text; }
+};
+
+struct TextRunKeyHash
+{
+	size_t operator()(const TextRunKey& key) const { return std::hash<std::string>()(key.text) ^ (static_cast<size_t>(key.size) * 0x9E3779B9); }
+};
+
+// Spans don't store a color so one cached run serves every color the string is drawn in
+static constexpr size_t MaxCachedTextRuns = 256;
+static unordered_map<int32, GlyphAtlas> glyphAtlases;
+static unordered_map<TextRunKey, TextRun, TextRunKeyHash> textRunCache;
+
+static const GlyphAtlas& GetGlyphAtlas(int32 size)
+{
+	auto found = glyphAtlases.find(size);
+	if (found != glyphAtlases.end())
+	{
+		return found->second;
+	}
 
-	int tempX = 0;
-	for (int x = left; x < left + width; x++)
+	GlyphAtlas& atlas = glyphAtlases[size];
+	for (int32 c = 0; c < 128; c++)
 	{
-		int tempY = 0;
-		for (int y = top; y < top + 5; y++)
+		atlas.firstSpan[c] = Cast<int32>(atlas.spans.size());
+
+		// Bits are stored column by column, 5 rows per column
+		const uint32 glyph = Font[c];
+		const int32 width = glyph >> 28;
+		for (int32 row = 0; row < 5; row++)
 		{
-			if ((glyph & 1) == 1)
+			int32 column = 0;
+			while (column < width)
 			{
-				if (size == 1)
+				if ((glyph >> (column * 5 + row) & 1) == 0)
 				{
-					SetPixel(x, y, color);
+					column++;
+					continue;
 				}
-				else
+
+				const int32 runStart = column;
+				while (column < width && (glyph >> (column * 5 + row) & 1) == 1)
+				{
+					column++;
+				}
+
+				for (int32 subRow = 0; subRow < size; subRow++)
 				{
-					DrawFilledRectangle(left + (tempX * size), top + (tempY * size), size, size, color);
+					atlas.spans.push_back(GlyphSpan { Cast<int16>(runStart * size), Cast<int16>(row * size + subRow), Cast<int16>((column - runStart) * size) });
 				}
 			}
+		}
+	}
+	atlas.firstSpan[128] = Cast<int32>(atlas.spans.size());
+	return atlas;
+}
+
+static const TextRun& GetTextRun(const std::string& s, int32 size)
+{
+	TextRunKey key { s, size };
+	auto found = textRunCache.find(key);
+	if (found != textRunCache.end())
+	{
+		return found->second;
+	}
+
+	if (textRunCache.size() >= MaxCachedTextRuns)
+	{
+		textRunCache.clear();
+	}
 
-			glyph = glyph >> 1;
-			tempY++;
+	const GlyphAtlas& atlas = GetGlyphAtlas(size);
+	TextRun run;
+	int32 x = 0;
+	for (char c : s)
+	{
+		const int32 glyphIndex = (c & 0x80) ? 0 : c;
+		for (int32 i = atlas.firstSpan[glyphIndex]; i < atlas.firstSpan[glyphIndex + 1]; i++)
+		{
+			GlyphSpan span = atlas.spans[i];
+			span.x = Cast<int16>(span.x + x);
+			run.spans.push_back(span);
 		}
-		tempX++;
+		x += ((GetGlyph(c) >> 28) * size) + static_cast<int32>(size * 0.5f);
 	}
-	
-	return width;
+
+	// Sort top to bottom and merge spans of neighbouring glyphs that touch
+	std::sort(run.spans.begin(), run.spans.end(), [](const GlyphSpan& lhs, const GlyphSpan& rhs)
+	{
+		return lhs.y != rhs.y ? lhs.y < rhs.y : lhs.x < rhs.x;
+	});
+
+	std::vector<GlyphSpan> mergedSpans;
+	for (const GlyphSpan& span : run.spans)
+	{
+		if (!mergedSpans.empty() && mergedSpans.back().y == span.y && mergedSpans.back().x + mergedSpans.back().length >= span.x)
+		{
+			GlyphSpan& previous = mergedSpans.back();
+			previous.length = Cast<int16>(std::max(previous.x + previous.length, span.x + span.length) - previous.x);
+			continue;
+		}
+		mergedSpans.push_back(span);
+	}
+	run.spans = std::move(mergedSpans);
+
+	return textRunCache.emplace(std::move(key), std::move(run)).first->second;
 }
 
 int32 GetStringWidth(const std::string& s)
@@ -470,8 +928,7 @@ int32 GetStringWidth(const std::string& s)
 	int32 width = 0;
 	for (char c : s)
 	{
-		unsigned int glyph = Font[c];
-		width += glyph >> 28;
+		width += GetGlyph(c) >> 28;
 	}
 	return width;	
 }
@@ -483,6 +940,12 @@ void DrawString(Vector2D pos, const std::string& s, Alignment alignment, Color c
 
 void DrawString(int32 x, int32 y, const std::string& s, Alignment alignment, const Color color, int32 size)
 {
+	SPROFILE_SCOPE("DrawString");
+	if (s.empty() || size <= 0)
+	{
+		return;
+	}
+
 	const float stringWidthFloat = GetStringWidth(s) * size + ((s.size() - 1) * 0.5f) * size;
 	const int32 stringWidth = static_cast<int32>(std::round(stringWidthFloat));
 	
@@ -495,25 +958,12 @@ void DrawString(int32 x, int32 y, const std::string& s, Alignment alignment, con
 			break;
 	}
 
-	int charIndex = 0;
-	for (char c : s)
+	const TextRun& run = GetTextRun(s, size);
+	DamageRect bounds { 0, 0, 0, 0 };
+	for (const GlyphSpan& span : run.spans)
 	{
-		int32 characterWidth = DrawCharacter(x, y, c, color, size);
-		x += (characterWidth * size) + static_cast<int32>(size * 0.5f);
-		charIndex++;
+		FillHorizontalSpan(framebufferTarget, x + span.x, x + span.x + span.length - 1, y + span.y, color);
+		bounds = bounds.IsEmpty() ? DamageRect { span.x, span.y, span.x + span.length, span.y + 1 } : GetUnion(bounds, DamageRect { span.x, span.y, span.x + span.length, span.y + 1 });
 	}
+	AddFramebufferDamage(x + bounds.minX, y + bounds.minY, bounds.GetWidth(), bounds.GetHeight());
 }
-
-
-bool SLoadImage(const std::string& path, SImage& outImage)
-{
-	outImage = {};
-	outImage.assetPath = path;
-	Gdiplus::Bitmap* loadedBitmap = new Gdiplus::Bitmap(StringToCString(path));
-	outImage.bitmap = loadedBitmap;
-	outImage.width = loadedBitmap->GetWidth();
-	outImage.height = loadedBitmap->GetHeight();
-	return true;
-}
-
-
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "SBlit.h"
 #include "SMath.h"
+#include "SPng.h"
 #include "Typedefs.h"
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
 #include <string>
+#include <vector>
 #define Cast static_cast
 
 static constexpr int32 Width = 160 * 2; // 160
@@ -75,12 +78,15 @@ struct SRect
 
 struct SImage
 {
-	// TODO[rsmekens]: can I store this as a void pointer by also including the memory size?
 	std::string assetPath;
-	void* bitmap;
+	// Decoded 0xAARRGGBB pixels, height rows that are GetPitch() pixels apart
+	Color* pixels;
 	int32 width;
 	int32 height;
+	// Distance between two rows in pixels, 0 means the rows are tightly packed
+	int32 pitch;
 
+	int32 GetPitch() const { return pitch > 0 ? pitch : width; }
 	int32 GetHalfWidth() const { return Cast<int32>(width / 2.f); }
 	int32 GetHalfHeight() const { return Cast<int32>(height / 2.f); }
 };
@@ -113,22 +119,42 @@ struct SSprite
 	}
 };
 
-// TODO[rsmekens]: create proper return codes?
-bool SLoadImage(const std::string& path, SImage& outImage);
+// Decodes a png file, outImage is left without pixels when it fails
+PngError SLoadImage(const std::string& path, SImage& outImage);
+// Decodes all paths in parallel, one worker thread per core. outImages and the returned errors line up with paths.
+std::vector<PngError> SLoadImages(const std::vector<std::string>& paths, std::vector<SImage>& outImages);
+// Frees the pixels allocated by SLoadImage and SLoadImages
+void SFreeImage(SImage& image);
 
 void Clear(Color clearColor = Black);
 void RenderGrid();
 void SetPixel(Vector2D pos, Color c);
 void SetPixel(int32 x, int32 y, Color c);
+
+// The framebuffer as a raster target, narrow its clip rectangle to draw into part of it
+SRasterTarget GetFramebufferTarget();
+// Drawing into GetFramebufferTarget() bypasses damage tracking, report what was drawn here or it won't be presented
+void AddFramebufferDamage(int32 x, int32 y, int32 width, int32 height);
+
 void DrawFilledRectangle(Vector2D pos, Vector2D size, Color c);
 void DrawFilledRectangle(int32 x, int32 y, int32 width, int32 height, Color c);
+void DrawFilledCircle(Vector2D center, float radius, Color c);
+void DrawFilledCircle(int32 centerX, int32 centerY, int32 radius, Color c);
+void DrawFilledEllipse(Vector2D center, Vector2D radius, Color c);
+void DrawFilledEllipse(int32 centerX, int32 centerY, int32 radiusX, int32 radiusY, Color c);
 void DrawRectangle(Vector2D pos, Vector2D size, Color c);
 void DrawRectangle(int32 x, int32 y, int32 width, int32 height, Color c);
 void DrawLine(int32 startX, int32 startY, int32 endX, int32 endY, Color c);
-// TODO[rsmekens]: add color multiply?
+// Lines between consecutive points, cheaper than a DrawLine per segment for plots and outlines
+void DrawPolyline(const std::vector<RasterPoint>& points, Color c);
+// Images are alpha blended unless another BlendMode is given, BlendMode::Multiply tints what is already drawn
 void DrawImage(const SImage& image, Vector2D position);
 void DrawImage(const SImage& image, int32 startX, int32 startY, int32 width = -1, int32 height = -1);
 void DrawImage(const SImage& image, const SRect& inDestRect, const SRect& inSrcRect);
+// flip takes BlitFlip bits
+void DrawImage(const SImage& image, const SRect& inDestRect, const SRect& inSrcRect, BlendMode mode, uint8 flip = BlitFlipNone);
+// Same, but only draws inside the clip rectangle of target, e.g. one tile of GetFramebufferTarget()
+void DrawImage(const SRasterTarget& target, const SImage& image, const SRect& inDestRect, const SRect& inSrcRect, BlendMode mode, uint8 flip = BlitFlipNone);
 
 void DrawSprite(const SSprite& sprite, const Vector2D& position);
 void DrawSprite(const SSprite& sprite, const Vector2D& position, const Vector2D& scale);
@@ -136,12 +162,25 @@ void DrawSprite(const SImage& image, const SRect& inDestRect, const SRect& inSrc
 
 // INPUT
 bool IsKeyDown(char key);
+// Went down or up since the previous Tick, also when it was tapped quicker than a frame
+bool WasKeyPressed(char key);
+bool WasKeyReleased(char key);
 int32 GetMouseX();
 int32 GetMouseY();
 // ~INPUT
 
 // APPLICATION
 void SetApplicationName(const std::string& newApplicationName);
+// Frames are paced to this rate without spinning, 0 runs uncapped. Defaults to 120.
+void SetTargetFrameRate(float framesPerSecond);
+float GetTargetFrameRate();
+// With a fixed time step Tick always gets that delta and runs as often as needed to keep up with real time, 0 disables it
+void SetFixedTimeStep(float seconds);
+// Fraction of a fixed step that real time is ahead of the simulation, to interpolate what is drawn between two steps
+float GetFrameInterpolation();
+// Seed for srand or any other generator, every call returns the next one. They all come from one seed per session
+// that recordings store, so a replay gets the same seeds.
+uint32 MakeRandomSeed();
 // ~APPLICATION
 
 // RENDERING UI 
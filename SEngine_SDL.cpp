@@ -0,0 +1,161 @@
+#if !defined(_WIN32)
+
+#include "SEngine.h"
+#include "SPlatform.h"
+#include "SHeadless.h"
+#include "SSynth.h"
+
+#include <SDL2/SDL.h>
+
+#include <iostream>
+
+// Games are written against win32 virtual key codes, translate the SDL keys we care about to those values
+static char TranslateKey(SDL_Keycode key)
+{
+	if (key >= SDLK_a && key <= SDLK_z)
+	{
+		return static_cast<char>('A' + (key - SDLK_a));
+	}
+	if (key >= SDLK_0 && key <= SDLK_9)
+	{
+		return static_cast<char>('0' + (key - SDLK_0));
+	}
+
+	switch (key)
+	{
+	case SDLK_LEFT: return 0x25;
+	case SDLK_UP: return 0x26;
+	case SDLK_RIGHT: return 0x27;
+	case SDLK_DOWN: return 0x28;
+	case SDLK_SPACE: return 0x20;
+	case SDLK_RETURN: return 0x0D;
+	case SDLK_ESCAPE: return 0x1B;
+	default: return 0;
+	}
+}
+
+// Runs on the SDL audio thread
+static void AudioCallback(void* /*userData*/, Uint8* stream, int length)
+{
+	GetSynth().ReadSamples(reinterpret_cast<int16*>(stream), static_cast<uint32>(length) / sizeof(int16));
+}
+
+int main(int argc, char* argv[])
+{
+	HeadlessSettings headlessSettings;
+	if (ParseHeadlessArguments(argc, argv, headlessSettings))
+	{
+		return RunHeadless(headlessSettings);
+	}
+	if (!headlessSettings.recordPath.empty() && !StartRecording(headlessSettings.recordPath))
+	{
+		std::cout << "Failed to open recording " << headlessSettings.recordPath << std::endl;
+	}
+	StartProfiling(headlessSettings.profilePath);
+
+	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
+	{
+		std::cout << "Initialization failed" << std::endl;
+		return 1;
+	}
+
+	SDL_AudioSpec desiredSpec = {};
+	desiredSpec.freq = PulseSynth::SampleRate;
+	desiredSpec.format = AUDIO_S16SYS;
+	desiredSpec.channels = 1;
+	desiredSpec.samples = 1024;
+	desiredSpec.callback = AudioCallback;
+	// Without audio the game still runs, PlayMidiNote just fills up the queue
+	const SDL_AudioDeviceID audioDevice = SDL_OpenAudioDevice(nullptr, 0, &desiredSpec, nullptr, 0);
+	if (audioDevice != 0)
+	{
+		SDL_PauseAudioDevice(audioDevice, 0);
+	}
+
+	SDL_Window* window = SDL_CreateWindow(GetApplicationName().c_str(),
+			SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, Width * PixelScale,
+			Height * PixelScale, SDL_WINDOW_SHOWN);
+	if (window == nullptr)
+	{
+		SDL_Quit();
+		return 2;
+	}
+
+	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+	// The framebuffer is uploaded as is, SDL does the nearest neighbour upscale to the window size
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, Width, Height);
+
+	Clear(Blue);
+
+	Start();
+
+	bool quit = false;
+	// Set when the window needs all of it drawn again, e.g. after being uncovered
+	bool bRedrawWindow = true;
+	SDL_Event event;
+	while (!quit)
+	{
+		while (SDL_PollEvent(&event))
+		{
+			switch (event.type)
+			{
+			case SDL_QUIT:
+				quit = true;
+				break;
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
+				// Keys without a translation would all end up as key 0
+				if (const char key = TranslateKey(event.key.keysym.sym))
+				{
+					PushInputEvent(MakeKeyEvent(event.type == SDL_KEYDOWN ? InputEventType::KeyDown : InputEventType::KeyUp, key));
+				}
+				break;
+			case SDL_MOUSEMOTION:
+				PushInputEvent(MakeMouseMoveEvent(event.motion.x / PixelScale, event.motion.y / PixelScale));
+				break;
+			case SDL_WINDOWEVENT:
+				bRedrawWindow = true;
+				break;
+			}
+		}
+
+		std::string title;
+		if (RunFrame(title))
+		{
+			SDL_SetWindowTitle(window, title.c_str());
+		}
+
+		// Only the regions that changed get uploaded, the texture keeps the rest from earlier frames
+		const std::vector<DamageRect>& presentRects = GetPresentRects();
+		for (const DamageRect& rect : presentRects)
+		{
+			const SDL_Rect textureRect { rect.minX, rect.minY, rect.GetWidth(), rect.GetHeight() };
+			SDL_UpdateTexture(texture, &textureRect, GetFramebuffer() + rect.minY * Width + rect.minX, Width * sizeof(Color));
+		}
+
+		// The back buffer isn't kept between presents, so a changed frame is still scaled up as a whole
+		if (!presentRects.empty() || bRedrawWindow)
+		{
+			SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+			SDL_RenderPresent(renderer);
+			bRedrawWindow = false;
+		}
+		MarkFramePresented();
+	}
+
+	if (audioDevice != 0)
+	{
+		SDL_CloseAudioDevice(audioDevice);
+	}
+	SDL_DestroyTexture(texture);
+	SDL_DestroyRenderer(renderer);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	FinishProfiling();
+
+	return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,281 @@
+#if defined(_WIN32)
+
+#include "SEngine.h"
+#include "SPlatform.h"
+#include "SHeadless.h"
+#include "SJobSystem.h"
+#include "SSynth.h"
+#include "SUpscale.h"
+
+#include <windows.h>
+#include <windowsx.h>
+
+// INCLUDES FOR AUDIO OUTPUT
+#include <mmeapi.h>
+#pragma comment(lib, "winmm.lib")
+// ~INCLUDES FOR AUDIO OUTPUT
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#define StringToCString(path) StringToWString(path).c_str()
+
+static unique_ptr<std::thread> musicThread;
+
+// The framebuffer at window size, WM_PAINT copies it 1:1 so GDI never has to stretch
+static constexpr int32 ScaledWidth = Width * PixelScale;
+static constexpr int32 ScaledHeight = Height * PixelScale;
+static std::vector<uint32> scaledFramebuffer(static_cast<size_t>(ScaledWidth) * ScaledHeight);
+static JobSystem presentJobs;
+
+// Forward declarations of functions included in this code module:
+LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
+
+// Streams the engine synth to the default wave out device
+void MusicTick()
+{
+	HANDLE bufferDoneEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	WAVEFORMATEX format = {};
+	format.wFormatTag = WAVE_FORMAT_PCM;
+	format.nChannels = 1;
+	format.nSamplesPerSec = PulseSynth::SampleRate;
+	format.wBitsPerSample = 16;
+	format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+	format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+	HWAVEOUT waveOut = nullptr;
+	if (waveOutOpen(&waveOut, WAVE_MAPPER, &format, reinterpret_cast<DWORD_PTR>(bufferDoneEvent), 0, CALLBACK_EVENT) != MMSYSERR_NOERROR)
+	{
+		CloseHandle(bufferDoneEvent);
+		return;
+	}
+
+	// A few buffers in flight so the device never runs dry, each one is ~23ms of audio
+	constexpr uint32 BufferCount = 3;
+	constexpr uint32 BufferSamples = 1024;
+	static int16 samples[BufferCount][BufferSamples];
+	WAVEHDR headers[BufferCount] = {};
+	// Written to the device and not marked WHDR_DONE by it yet
+	bool bQueued[BufferCount] = {};
+	for (uint32 i = 0; i < BufferCount; i++)
+	{
+		headers[i].lpData = reinterpret_cast<LPSTR>(samples[i]);
+		headers[i].dwBufferLength = sizeof(samples[i]);
+		waveOutPrepareHeader(waveOut, &headers[i], sizeof(WAVEHDR));
+	}
+
+	PulseSynth& synth = GetSynth();
+	while (true)
+	{
+		uint32 buffersPlaying = 0;
+		for (uint32 i = 0; i < BufferCount; i++)
+		{
+			if (bQueued[i] && (headers[i].dwFlags & WHDR_DONE) != 0)
+			{
+				bQueued[i] = false;
+			}
+			if (bQueued[i])
+			{
+				buffersPlaying++;
+			}
+		}
+
+		// Nothing left to play, sleep until the game queues a note instead of feeding silence
+		if (buffersPlaying == 0 && synth.IsIdle())
+		{
+			synth.WaitForNotes();
+		}
+
+		for (uint32 i = 0; i < BufferCount; i++)
+		{
+			// Once the synth goes quiet the buffers still in flight are left to drain
+			if (!bQueued[i] && !synth.IsIdle())
+			{
+				synth.ReadSamples(samples[i], BufferSamples);
+				waveOutWrite(waveOut, &headers[i], sizeof(WAVEHDR));
+				bQueued[i] = true;
+			}
+		}
+
+		WaitForSingleObject(bufferDoneEvent, INFINITE);
+	}
+
+	waveOutReset(waveOut);
+	for (WAVEHDR& header : headers)
+	{
+		waveOutUnprepareHeader(waveOut, &header, sizeof(WAVEHDR));
+	}
+	waveOutClose(waveOut);
+	CloseHandle(bufferDoneEvent);
+}
+
+
+int APIENTRY wWinMain(HINSTANCE hInstance,
+					  HINSTANCE hPrevInstance,
+					  LPWSTR    lpCmdLine,
+					  int nCmdShow)
+{
+	{
+		std::vector<std::string> arguments;
+		std::vector<const char*> argumentPointers;
+		for (int i = 0; i < __argc; i++)
+		{
+			const std::wstring argument = __wargv[i];
+			arguments.push_back(std::string(argument.begin(), argument.end()));
+		}
+		for (const std::string& argument : arguments)
+		{
+			argumentPointers.push_back(argument.c_str());
+		}
+
+		HeadlessSettings headlessSettings;
+		if (ParseHeadlessArguments(__argc, argumentPointers.data(), headlessSettings))
+		{
+			return RunHeadless(headlessSettings);
+		}
+		if (!headlessSettings.recordPath.empty() && !StartRecording(headlessSettings.recordPath))
+		{
+			std::cout << "Failed to open recording " << headlessSettings.recordPath << std::endl;
+		}
+		StartProfiling(headlessSettings.profilePath);
+	}
+
+	WNDCLASS windowClass = {}; // reserves memory on the stack but set's everything to zero
+	// https://docs.microsoft.com/en-us/windows/win32/winmsg/window-class-styles
+	windowClass.style = CS_HREDRAW | CS_VREDRAW;
+	// Flags that decide that we need to repaint the whole window  (otherwise will only repaint the resize section)
+	windowClass.lpfnWndProc = WndProc;
+	windowClass.hInstance = hInstance;
+	//windowClass.hIcon;
+	windowClass.lpszClassName = L"PONG";
+	if (!RegisterClass(&windowClass)) return 1;
+
+	const DWORD style = WS_OVERLAPPED | WS_SYSMENU | WS_CAPTION;
+
+	RECT r{ 0, 0, Width * PixelScale, Height * PixelScale};
+	AdjustWindowRect(&r, style, FALSE);
+
+	HWND window = CreateWindowEx(0, windowClass.lpszClassName, L"Window Name - SDRAW",
+									WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT,
+									r.right - r.left, r.bottom - r.top, 0, 0, hInstance, 0);
+	if (window == nullptr) return 1;
+
+	Clear(Blue);
+
+	// START MUSIC FUNCTIONALITY
+	musicThread = make_unique<std::thread>(MusicTick);
+	musicThread->detach();
+	// ~START MUSIC FUNCTIONALITY
+
+	ShowWindow(window, nCmdShow);
+	UpdateWindow(window);
+
+	Start();
+
+	// Lets the frame scheduler sleep with 1ms precision instead of the default ~15ms
+	timeBeginPeriod(1);
+
+	MSG message = {};
+	bool bQuit = false;
+	while (!bQuit)
+	{
+		while (PeekMessage(&message, nullptr, 0, 0, PM_REMOVE))
+		{
+			if (message.message == WM_QUIT)
+			{
+				bQuit = true;
+				break;
+			}
+			TranslateMessage(&message);
+			DispatchMessage(&message);
+		}
+		if (bQuit)
+		{
+			break;
+		}
+
+		std::string title;
+		if (RunFrame(title))
+		{
+			SetWindowText(window, StringToCString(title));
+		}
+		// Only the regions that changed get upscaled and painted, see WM_PAINT
+		for (const DamageRect& damage : GetPresentRects())
+		{
+			UpscaleNearest(GetFramebuffer(), Width, UpscaleImage { scaledFramebuffer.data(), ScaledWidth }, PixelScale, damage, presentJobs);
+			const RECT windowRect { damage.minX * PixelScale, damage.minY * PixelScale, damage.maxX * PixelScale, damage.maxY * PixelScale };
+			InvalidateRect(window, &windowRect, false);
+		}
+		// Paint now instead of whenever the next message comes in, so the frame is on screen when it's marked presented
+		UpdateWindow(window);
+		MarkFramePresented();
+	}
+
+	timeEndPeriod(1);
+
+	FinishProfiling();
+
+	return (int) message.wParam;
+}
+
+LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	switch (message)
+	{
+	case WM_PAINT:
+		{
+			PAINTSTRUCT ps;
+			HDC hdc = BeginPaint(hWnd, &ps);
+
+			const int32 minX = std::clamp(static_cast<int32>(ps.rcPaint.left), 0, ScaledWidth);
+			const int32 minY = std::clamp(static_cast<int32>(ps.rcPaint.top), 0, ScaledHeight);
+			const int32 maxX = std::clamp(static_cast<int32>(ps.rcPaint.right), 0, ScaledWidth);
+			const int32 maxY = std::clamp(static_cast<int32>(ps.rcPaint.bottom), 0, ScaledHeight);
+
+			if (minX < maxX && minY < maxY)
+			{
+				// Negative height tells GDI the rows are stored top-down. The bitmap starts at row minY, so the source
+				// rectangle never depends on how GDI measures rows of a top-down bitmap.
+				BITMAPINFO bitmapInfo = {};
+				bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+				bitmapInfo.bmiHeader.biWidth = ScaledWidth;
+				bitmapInfo.bmiHeader.biHeight = -(maxY - minY);
+				bitmapInfo.bmiHeader.biPlanes = 1;
+				bitmapInfo.bmiHeader.biBitCount = 32;
+				bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+				SetDIBitsToDevice(hdc, minX, minY, maxX - minX, maxY - minY, minX, 0, 0, maxY - minY,
+					scaledFramebuffer.data() + static_cast<size_t>(minY) * ScaledWidth, &bitmapInfo, DIB_RGB_COLORS);
+			}
+
+			EndPaint(hWnd, &ps);
+		}
+		break;
+	case WM_KEYDOWN:
+		PushInputEvent(MakeKeyEvent(InputEventType::KeyDown, static_cast<char>(wParam)));
+		if (wParam == VK_ESCAPE)
+		{
+			// TODO[rsmekens]: quit application
+		}
+		break;
+	case WM_MOUSEMOVE:
+		PushInputEvent(MakeMouseMoveEvent(GET_X_LPARAM(lParam) / PixelScale, GET_Y_LPARAM(lParam) / PixelScale));
+		break;
+	case WM_KEYUP:
+		PushInputEvent(MakeKeyEvent(InputEventType::KeyUp, static_cast<char>(wParam)));
+		break;
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		break;
+	default:
+		return DefWindowProc(hWnd, message, wParam, lParam);
+	}
+	return 0;
+}
+
+#endif
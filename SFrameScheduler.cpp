@@ -0,0 +1,114 @@
+#include "SFrameScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std::chrono;
+
+// Fixed steps per frame before the simulation gives up on catching up
+static constexpr int32 MaxFixedSteps = 8;
+static constexpr double StatsPeriod = 0.5;
+// Longest overshoot the scheduler plans for, well below a frame at the usual rates
+static constexpr double MaxSleepOvershoot = 0.004;
+
+void FrameScheduler::SetTargetFrameRate(float framesPerSecond)
+{
+	targetFrameRate = std::max(framesPerSecond, 0.f);
+}
+
+void FrameScheduler::SetFixedTimeStep(float seconds)
+{
+	fixedTimeStep = std::max(seconds, 0.f);
+	accumulator = 0.f;
+}
+
+void FrameScheduler::SleepUntil(Clock::time_point deadline)
+{
+	// One sleep that even a late wake up finishes before the deadline
+	const Clock::time_point start = Clock::now();
+	const double requested = duration<double>(deadline - start).count() - sleepOvershootEstimate;
+	if (requested > 0.0)
+	{
+		std::this_thread::sleep_for(duration<double>(requested));
+		const double slept = duration<double>(Clock::now() - start).count();
+		// Moving mean and variance of the overshoot, a rare late wake up shouldn't turn every frame into a spin
+		const double overshoot = std::max(slept - requested, 0.0);
+		overshootMean += (overshoot - overshootMean) * 0.05;
+		overshootVariance += ((overshoot - overshootMean) * (overshoot - overshootMean) - overshootVariance) * 0.05;
+		// Capped so a stretch of bad wake ups can't grow the spin until the sleep never happens and the estimate stops adapting
+		sleepOvershootEstimate = std::min(overshootMean + 2.0 * std::sqrt(overshootVariance), MaxSleepOvershoot);
+	}
+
+	// Busy wait the remaining sub-millisecond, a yield could hand the core away for a whole scheduler slice
+	while (Clock::now() < deadline)
+	{
+	}
+}
+
+float FrameScheduler::WaitForNextFrame()
+{
+	if (!bStarted)
+	{
+		bStarted = true;
+		lastFrame = Clock::now();
+		nextFrame = lastFrame;
+		statsStart = lastFrame;
+	}
+
+	if (targetFrameRate > 0.f)
+	{
+		const auto frameDuration = duration_cast<Clock::duration>(duration<double>(1.0 / targetFrameRate));
+		nextFrame += frameDuration;
+
+		// Fell more than a frame behind, start over from now instead of rushing frames to catch up
+		const Clock::time_point now = Clock::now();
+		if (nextFrame < now - frameDuration)
+		{
+			nextFrame = now;
+		}
+		SleepUntil(nextFrame);
+	}
+
+	const Clock::time_point now = Clock::now();
+	const float frameTime = duration<float>(now - lastFrame).count();
+	lastFrame = now;
+	statsFrames++;
+	return frameTime;
+}
+
+int32 FrameScheduler::ConsumeFixedSteps(float frameTime)
+{
+	if (fixedTimeStep <= 0.f)
+	{
+		return 1;
+	}
+
+	accumulator = std::min(accumulator + frameTime, fixedTimeStep * MaxFixedSteps);
+	int32 steps = 0;
+	while (accumulator >= fixedTimeStep)
+	{
+		accumulator -= fixedTimeStep;
+		steps++;
+	}
+	return steps;
+}
+
+float FrameScheduler::GetInterpolation() const
+{
+	return fixedTimeStep > 0.f ? accumulator / fixedTimeStep : 0.f;
+}
+
+bool FrameScheduler::ConsumeStatsUpdate(float& outAverageFrameMs)
+{
+	const double elapsed = duration<double>(lastFrame - statsStart).count();
+	if (!bStarted || elapsed < StatsPeriod || statsFrames == 0)
+	{
+		return false;
+	}
+
+	outAverageFrameMs = static_cast<float>(elapsed * 1000.0 / statsFrames);
+	statsStart = lastFrame;
+	statsFrames = 0;
+	return true;
+}
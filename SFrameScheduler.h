@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <chrono>
+
+// Paces the platform game loop to a target frame rate without burning a core.
+// Sleeps once for the frame minus the expected OS wake up error, then spins for the last sub-millisecond.
+// Optionally splits the elapsed time into fixed simulation steps and keeps the leftover as interpolation factor.
+class FrameScheduler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// 0 means uncapped
+	void SetTargetFrameRate(float framesPerSecond);
+	float GetTargetFrameRate() const { return targetFrameRate; }
+
+	// 0 means the simulation gets the variable frame time
+	void SetFixedTimeStep(float seconds);
+	float GetFixedTimeStep() const { return fixedTimeStep; }
+
+	// Blocks until the next frame is due and returns the seconds since the previous one
+	float WaitForNextFrame();
+
+	// Amount of simulation steps to run for frameTime, capped so a long stall doesn't snowball into longer frames
+	int32 ConsumeFixedSteps(float frameTime);
+	// Fraction of a fixed step that is left over after the last ConsumeFixedSteps, in [0, 1)
+	float GetInterpolation() const;
+
+	// Returns true twice a second with the average frame time of that period, so window titles aren't rebuilt every frame
+	bool ConsumeStatsUpdate(float& outAverageFrameMs);
+
+private:
+	void SleepUntil(Clock::time_point deadline);
+
+	float targetFrameRate = 120.f;
+	float fixedTimeStep = 0.f;
+	float accumulator = 0.f;
+
+	bool bStarted = false;
+	Clock::time_point lastFrame;
+	Clock::time_point nextFrame;
+
+	// How much longer a sleep takes than asked, in seconds. The estimate is mean + 2 standard deviations.
+	double sleepOvershootEstimate = 0.001;
+	double overshootMean = 0.0005;
+	double overshootVariance = 0.0;
+
+	Clock::time_point statsStart;
+	int32 statsFrames = 0;
+};
@@ -0,0 +1,236 @@
+#include "SHeadless.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+bool HeadlessSettings::ShouldDumpFrame(int32 frame) const
+{
+	if (bDumpAllFrames)
+	{
+		return true;
+	}
+	return std::find(dumpFrames.begin(), dumpFrames.end(), frame) != dumpFrames.end();
+}
+
+std::string HeadlessSettings::GetFramePath(int32 frame) const
+{
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "frame_%05d.%s", frame, format.c_str());
+	return outputDirectory + "/" + fileName;
+}
+
+bool ParseHeadlessArguments(int argc, const char* const* argv, HeadlessSettings& outSettings)
+{
+	bool bHeadless = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		const bool bHasValue = i + 1 < argc;
+
+		if (std::strcmp(argument, "--headless") == 0)
+		{
+			bHeadless = true;
+		}
+		else if (std::strcmp(argument, "--frames") == 0 && bHasValue)
+		{
+			outSettings.frameCount = std::max(std::atoi(argv[++i]), 0);
+		}
+		else if (std::strcmp(argument, "--delta") == 0 && bHasValue)
+		{
+			outSettings.deltaTime = static_cast<float>(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argument, "--dump") == 0 && bHasValue)
+		{
+			// Comma separated list of frames or "all"
+			const std::string frames = argv[++i];
+			if (frames == "all")
+			{
+				outSettings.bDumpAllFrames = true;
+				continue;
+			}
+
+			std::stringstream stream(frames);
+			std::string frame;
+			while (std::getline(stream, frame, ','))
+			{
+				outSettings.dumpFrames.push_back(std::atoi(frame.c_str()));
+			}
+		}
+		else if (std::strcmp(argument, "--out") == 0 && bHasValue)
+		{
+			outSettings.outputDirectory = argv[++i];
+		}
+		else if (std::strcmp(argument, "--format") == 0 && bHasValue)
+		{
+			outSettings.format = argv[++i];
+		}
+		else if (std::strcmp(argument, "--audio") == 0 && bHasValue)
+		{
+			outSettings.audioPath = argv[++i];
+		}
+		else if (std::strcmp(argument, "--profile") == 0 && bHasValue)
+		{
+			outSettings.profilePath = argv[++i];
+		}
+		else if (std::strcmp(argument, "--record") == 0 && bHasValue)
+		{
+			outSettings.recordPath = argv[++i];
+		}
+		else if (std::strcmp(argument, "--replay") == 0 && bHasValue)
+		{
+			outSettings.replayPath = argv[++i];
+			bHeadless = true;
+		}
+	}
+	return bHeadless;
+}
+
+bool WriteFramePPM(const std::string& path, const uint32* pixels, int32 width, int32 height)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	std::vector<uint8> row(width * 3);
+	for (int32 y = 0; y < height; y++)
+	{
+		for (int32 x = 0; x < width; x++)
+		{
+			const uint32 pixel = pixels[y * width + x];
+			row[x * 3 + 0] = static_cast<uint8>(pixel >> 16);
+			row[x * 3 + 1] = static_cast<uint8>(pixel >> 8);
+			row[x * 3 + 2] = static_cast<uint8>(pixel >> 0);
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+	return file.good();
+}
+
+static uint32 Crc32(const uint8* data, size_t size, uint32 crc = 0)
+{
+	static uint32 table[256];
+	static bool bTableBuilt = false;
+	if (!bTableBuilt)
+	{
+		for (uint32 i = 0; i < 256; i++)
+		{
+			uint32 value = i;
+			for (int32 bit = 0; bit < 8; bit++)
+			{
+				value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+			}
+			table[i] = value;
+		}
+		bTableBuilt = true;
+	}
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static void AppendBigEndian(std::vector<uint8>& buffer, uint32 value)
+{
+	buffer.push_back(static_cast<uint8>(value >> 24));
+	buffer.push_back(static_cast<uint8>(value >> 16));
+	buffer.push_back(static_cast<uint8>(value >> 8));
+	buffer.push_back(static_cast<uint8>(value >> 0));
+}
+
+static void WriteChunk(std::ofstream& file, const char* type, const std::vector<uint8>& data)
+{
+	std::vector<uint8> chunk;
+	AppendBigEndian(chunk, static_cast<uint32>(data.size()));
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+	AppendBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+	file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+// Writes an RGBA png with uncompressed (stored) deflate blocks, frames only need to be exact, not small
+bool WriteFramePNG(const std::string& path, const uint32* pixels, int32 width, int32 height)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	static const uint8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	std::vector<uint8> header;
+	AppendBigEndian(header, width);
+	AppendBigEndian(header, height);
+	header.push_back(8); // bit depth
+	header.push_back(6); // color type RGBA
+	header.push_back(0); // compression
+	header.push_back(0); // filter
+	header.push_back(0); // interlace
+	WriteChunk(file, "IHDR", header);
+
+	// Every row starts with filter type 0 (none)
+	std::vector<uint8> raw;
+	raw.reserve(height * (width * 4 + 1));
+	for (int32 y = 0; y < height; y++)
+	{
+		raw.push_back(0);
+		for (int32 x = 0; x < width; x++)
+		{
+			const uint32 pixel = pixels[y * width + x];
+			raw.push_back(static_cast<uint8>(pixel >> 16));
+			raw.push_back(static_cast<uint8>(pixel >> 8));
+			raw.push_back(static_cast<uint8>(pixel >> 0));
+			raw.push_back(static_cast<uint8>(pixel >> 24));
+		}
+	}
+
+	std::vector<uint8> zlib = { 0x78, 0x01 };
+	size_t offset = 0;
+	do
+	{
+		const size_t blockSize = std::min<size_t>(raw.size() - offset, 0xFFFF);
+		const bool bLastBlock = offset + blockSize == raw.size();
+		zlib.push_back(bLastBlock ? 1 : 0);
+		zlib.push_back(static_cast<uint8>(blockSize & 0xFF));
+		zlib.push_back(static_cast<uint8>(blockSize >> 8));
+		zlib.push_back(static_cast<uint8>(~blockSize & 0xFF));
+		zlib.push_back(static_cast<uint8>((~blockSize >> 8) & 0xFF));
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < raw.size());
+
+	uint32 adlerA = 1;
+	uint32 adlerB = 0;
+	for (uint8 value : raw)
+	{
+		adlerA = (adlerA + value) % 65521;
+		adlerB = (adlerB + adlerA) % 65521;
+	}
+	AppendBigEndian(zlib, (adlerB << 16) | adlerA);
+	WriteChunk(file, "IDAT", zlib);
+
+	WriteChunk(file, "IEND", {});
+	return file.good();
+}
+
+bool WriteFrame(const std::string& path, const uint32* pixels, int32 width, int32 height)
+{
+	const size_t extensionStart = path.find_last_of('.');
+	if (extensionStart != std::string::npos && path.substr(extensionStart) == ".png")
+	{
+		return WriteFramePNG(path, pixels, width, height);
+	}
+	return WriteFramePPM(path, pixels, width, height);
+}
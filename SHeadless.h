@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <string>
+#include <vector>
+
+// Settings to run a game without a window for a fixed amount of frames, used for CI and benchmarking
+// Example: game.out --headless --frames 600 --delta 0.016 --dump 1,300,600 --out frames --format png --audio music.wav
+// --record session.replay records any run, windowed or not. --replay session.replay runs headless with the recorded
+// seed, deltas and input instead of --frames and --delta.
+struct HeadlessSettings
+{
+	int32 frameCount = 600;
+	float deltaTime = 1.f / 60.f;
+
+	// 1 based frame numbers that get written to disk, empty means nothing is written unless bDumpAllFrames is set
+	std::vector<int32> dumpFrames;
+	bool bDumpAllFrames = false;
+	std::string outputDirectory = ".";
+	std::string format = "ppm";
+	// Everything the game plays gets written to this .wav file, empty means no audio
+	std::string audioPath;
+	// Profiler zones of the whole run get exported to this chrome trace .json file, empty leaves the profiler off.
+	// Windowed runs use it as well.
+	std::string profilePath;
+	// See SReplay.h, empty means no recording or replay
+	std::string recordPath;
+	std::string replayPath;
+
+	bool ShouldDumpFrame(int32 frame) const;
+	std::string GetFramePath(int32 frame) const;
+};
+
+// Returns true when --headless or --replay was passed, all other recognised arguments are written into outSettings
+bool ParseHeadlessArguments(int argc, const char* const* argv, HeadlessSettings& outSettings);
+
+// Pixels are 0xAARRGGBB rows of width pixels, alpha is dropped for ppm
+bool WriteFramePPM(const std::string& path, const uint32* pixels, int32 width, int32 height);
+bool WriteFramePNG(const std::string& path, const uint32* pixels, int32 width, int32 height);
+// Picks the format based on the extension of the path
+bool WriteFrame(const std::string& path, const uint32* pixels, int32 width, int32 height);
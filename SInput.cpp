@@ -0,0 +1,39 @@
+#include "SInput.h"
+
+#include <chrono>
+
+void KeyBits::GetKeys(std::vector<char>& outKeys) const
+{
+	outKeys.clear();
+	for (uint32 key = 0; key < 256; key++)
+	{
+		if (Test(static_cast<uint8>(key)))
+		{
+			outKeys.push_back(static_cast<char>(key));
+		}
+	}
+}
+
+void KeyBits::SetKeys(const std::vector<char>& keys)
+{
+	Clear();
+	for (const char key : keys)
+	{
+		Set(static_cast<uint8>(key));
+	}
+}
+
+InputEvent MakeKeyEvent(InputEventType type, char key)
+{
+	return InputEvent { type, static_cast<uint8>(key), 0, 0, GetInputTimestamp() };
+}
+
+InputEvent MakeMouseMoveEvent(int32 x, int32 y)
+{
+	return InputEvent { InputEventType::MouseMove, 0, static_cast<int16>(x), static_cast<int16>(y), GetInputTimestamp() };
+}
+
+uint64 GetInputTimestamp()
+{
+	return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
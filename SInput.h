@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SSpscQueue.h"
+#include "Typedefs.h"
+
+#include <vector>
+
+// Keyboard state as bitsets, one bit per key code, so every query is a shift and a mask.
+// The platform layer pushes timestamped events into an InputEventQueue as they arrive, the engine applies them right
+// before the next tick and knows from the timestamps how long input waited until it was presented.
+
+struct KeyBits
+{
+	uint64 words[4] = {};
+
+	bool Test(uint8 key) const { return (words[key >> 6] >> (key & 63)) & 1; }
+	void Set(uint8 key) { words[key >> 6] |= 1ull << (key & 63); }
+	void Reset(uint8 key) { words[key >> 6] &= ~(1ull << (key & 63)); }
+	void Clear() { words[0] = words[1] = words[2] = words[3] = 0; }
+
+	// Key codes of the set bits in ascending order, and back
+	void GetKeys(std::vector<char>& outKeys) const;
+	void SetKeys(const std::vector<char>& keys);
+};
+
+struct KeyboardState
+{
+	KeyBits down;
+	// Keys that went down or up since the last ClearEdges, a tap shorter than a frame shows up in both
+	KeyBits pressed;
+	KeyBits released;
+
+	void Press(uint8 key)
+	{
+		if (!down.Test(key))
+		{
+			down.Set(key);
+			pressed.Set(key);
+		}
+	}
+
+	void Release(uint8 key)
+	{
+		if (down.Test(key))
+		{
+			down.Reset(key);
+			released.Set(key);
+		}
+	}
+
+	void ClearEdges()
+	{
+		pressed.Clear();
+		released.Clear();
+	}
+};
+
+enum class InputEventType : uint8
+{
+	KeyDown,
+	KeyUp,
+	MouseMove,
+};
+
+struct InputEvent
+{
+	InputEventType type;
+	uint8 key;
+	int16 mouseX;
+	int16 mouseY;
+	// GetInputTimestamp when the platform received it
+	uint64 timestamp;
+};
+
+// Filled by the thread that pumps the platform messages, drained by the thread running the ticks
+using InputEventQueue = SpscQueue<InputEvent, 256>;
+
+// Nanoseconds on a monotonic clock
+uint64 GetInputTimestamp();
+// Events stamped with the current time
+InputEvent MakeKeyEvent(InputEventType type, char key);
+InputEvent MakeMouseMoveEvent(int32 x, int32 y);
@@ -0,0 +1,145 @@
+#include "SJobSystem.h"
+#include "SWait.h"
+
+// Which queue the calling thread owns, threads outside any JobSystem use the shared queue 0
+static thread_local const JobSystem* currentJobSystem = nullptr;
+static thread_local uint32 currentQueueIndex = 0;
+
+JobSystem::JobSystem(uint32 threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (uint32 i = 0; i < threadCount; i++)
+	{
+		queues.push_back(std::make_unique<JobQueue>());
+	}
+	for (uint32 i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back([this, i]() { WorkerMain(i); });
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	bStopping = true;
+	jobSignal++;
+	WakeAllWaiters(jobSignal);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void JobSystem::Submit(std::function<void()> job, JobCounter& counter)
+{
+	counter.pending++;
+	if (threads.empty())
+	{
+		Job inlineJob { std::move(job), &counter };
+		RunJob(inlineJob);
+		return;
+	}
+
+	JobQueue& queue = *queues[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(Job { std::move(job), &counter });
+	}
+	jobSignal++;
+	WakeOneWaiter(jobSignal);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const uint32 queueIndex = GetQueueIndex();
+	while (true)
+	{
+		// Read before checking the counter, a submit or the last job of counter finishing after this changes the value
+		// and the wait below returns right away
+		const uint32 signal = jobSignal.load();
+		if (counter.pending.load() == 0)
+		{
+			return;
+		}
+		// Only sleep once nothing is left to help with. Jobs submitted later, like the ones those jobs submit, wake us
+		// to help again.
+		if (!TryRunJob(queueIndex))
+		{
+			WaitOnValue(jobSignal, signal);
+		}
+	}
+}
+
+uint32 JobSystem::GetQueueIndex() const
+{
+	return currentJobSystem == this ? currentQueueIndex : 0;
+}
+
+bool JobSystem::TryRunJob(uint32 queueIndex)
+{
+	Job job;
+	bool bFound = false;
+	{
+		// Newest job of our own queue first, its data is most likely still in cache
+		JobQueue& queue = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			bFound = true;
+		}
+	}
+
+	// Steal the oldest job of another queue, starting at the next one so thieves spread out
+	for (size_t offset = 1; !bFound && offset < queues.size(); offset++)
+	{
+		JobQueue& queue = *queues[(queueIndex + offset) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			bFound = true;
+		}
+	}
+
+	if (bFound)
+	{
+		RunJob(job);
+	}
+	return bFound;
+}
+
+void JobSystem::RunJob(Job& job)
+{
+	job.function();
+	// The waiter can return and free the counter as soon as it reads zero, so the wake goes through jobSignal and the
+	// counter isn't touched after the decrement
+	if (--job.counter->pending == 0)
+	{
+		jobSignal++;
+		WakeAllWaiters(jobSignal);
+	}
+}
+
+void JobSystem::WorkerMain(uint32 queueIndex)
+{
+	currentJobSystem = this;
+	currentQueueIndex = queueIndex;
+	while (true)
+	{
+		// Read before looking for jobs, a submit after this changes the value and the wait below returns right away
+		const uint32 signal = jobSignal.load();
+		if (bStopping)
+		{
+			return;
+		}
+		if (!TryRunJob(queueIndex))
+		{
+			WaitOnValue(jobSignal, signal);
+		}
+	}
+}
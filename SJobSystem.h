@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing job scheduler. Every worker thread owns a deque, it pushes and pops its own jobs at the back while idle
+// workers steal the oldest jobs from the front of the others. Threads outside the system submit into a shared deque.
+// Waiting on a JobCounter runs other jobs until the counter drops to zero, so jobs can wait on jobs they submitted.
+//
+// JobCounter counter;
+// jobs.Submit([]() { ... }, counter);
+// jobs.Wait(counter);
+
+struct JobCounter
+{
+	// Jobs submitted with this counter that haven't finished yet
+	std::atomic<uint32> pending { 0 };
+};
+
+class JobSystem
+{
+public:
+	// 0 uses one thread per core. The thread calling Wait also runs jobs, so 1 runs every job on the submitting thread.
+	explicit JobSystem(uint32 threadCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void Submit(std::function<void()> job, JobCounter& counter);
+	// Runs jobs until every job submitted with counter finished
+	void Wait(JobCounter& counter);
+
+	// Calls func(begin, end) on chunks of [0, count) and returns once all of them ran. Chunks hold at least minChunkSize
+	// items, so loops that are too short to be worth splitting run on the caller without touching the workers.
+	template<typename Func>
+	void ParallelFor(uint32 count, uint32 minChunkSize, Func&& func);
+
+	uint32 GetThreadCount() const { return static_cast<uint32>(threads.size()) + 1; }
+
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter;
+	};
+
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void WorkerMain(uint32 queueIndex);
+	uint32 GetQueueIndex() const;
+	bool TryRunJob(uint32 queueIndex);
+	void RunJob(Job& job);
+
+	std::vector<std::thread> threads;
+	// Queue 0 is shared by every thread that isn't a worker, worker i owns queue i
+	std::vector<std::unique_ptr<JobQueue>> queues;
+	// Bumped on every submit and whenever a counter reaches zero, workers and threads in Wait sleep on it
+	std::atomic<uint32> jobSignal { 0 };
+	std::atomic<bool> bStopping { false };
+};
+
+template<typename Func>
+void JobSystem::ParallelFor(uint32 count, uint32 minChunkSize, Func&& func)
+{
+	// A few chunks per thread leave room for stealing when chunks take uneven time
+	const uint32 maxChunkCount = GetThreadCount() * 4;
+	const uint32 chunkSize = std::max({ minChunkSize, 1u, (count + maxChunkCount - 1) / maxChunkCount });
+	if (count <= chunkSize)
+	{
+		if (count > 0)
+		{
+			func(0u, count);
+		}
+		return;
+	}
+
+	JobCounter counter;
+	for (uint32 begin = chunkSize; begin < count; begin += chunkSize)
+	{
+		const uint32 end = std::min(begin + chunkSize, count);
+		Submit([&func, begin, end]() { func(begin, end); }, counter);
+	}
+	func(0u, chunkSize);
+	Wait(counter);
+}
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <cmath>
+#include <cstdlib>
 
 struct Vector2D
 {
@@ -19,7 +20,7 @@ struct Vector2D
 
     void Normalize()
     {
-        float size = std::sqrtf(x*x + y*y);
+        float size = std::sqrt(x*x + y*y);
         if (size == 0.0f)
         {
             x = 0.0f;
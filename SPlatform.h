@@ -0,0 +1,59 @@
+#pragma once
+
+#include "SDamage.h"
+#include "SEngine.h"
+#include "SInput.h"
+
+#include <string>
+#include <vector>
+
+struct HeadlessSettings;
+
+// Shared between the portable engine core (SEngine.cpp) and the platform layers (SEngine_Win32.cpp, SEngine_SDL.cpp).
+// Games only include SEngine.h.
+
+// GAME
+void Start();
+void Tick(float deltaTime);
+// ~GAME
+
+// FRAMEBUFFER
+// All drawing goes into a single Width * Height buffer of 0xAARRGGBB pixels, the platform presents it once per frame
+const Color* GetFramebuffer();
+// Regions that differ from what the previous call returned, the platform only has to upload and scale these.
+// Draw calls record their bounds, so only those are compared. The first call returns the whole framebuffer.
+const std::vector<DamageRect>& GetPresentRects();
+// ~FRAMEBUFFER
+
+// AUDIO
+// PlayMidiNote queues into a PulseSynth owned by the engine, the platform pulls PCM out of it on its audio thread
+class PulseSynth;
+PulseSynth& GetSynth();
+// ~AUDIO
+
+// INPUT
+// Platform layers push input as it arrives, RunFrame applies everything pushed so far before the next tick.
+// Timestamps come from GetInputTimestamp, they measure how long input takes to reach MarkFramePresented.
+void PushInputEvent(const InputEvent& event);
+// Call right after a frame was presented
+void MarkFramePresented();
+// Change the input right away instead of before the next tick, for tools and tests that drive Tick themselves
+void AddKeyDown(char key);
+void RemoveKeyDown(char key);
+void SetMousePosition(int32 x, int32 y);
+// ~INPUT
+
+// APPLICATION
+const std::string& GetApplicationName();
+// inputLatencyMs is left out of the title when negative
+std::string MakeWindowTitle(float frameMs, float inputLatencyMs = -1.f);
+// Records every Tick from here on to path, call it before Start so the recording has the seed Start uses
+bool StartRecording(const std::string& path);
+// Turns the profiler on when path isn't empty, FinishProfiling turns it off again and writes the trace to path
+void StartProfiling(const std::string& path);
+void FinishProfiling();
+// Waits until the next frame is due and runs the Ticks for it, returns true when the window title should be set to outTitle
+bool RunFrame(std::string& outTitle);
+// Runs Start and a fixed amount of Ticks into the framebuffer without a window, returns the process exit code
+int RunHeadless(const HeadlessSettings& settings);
+// ~APPLICATION
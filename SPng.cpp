@@ -0,0 +1,726 @@
+#include "SPng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+// INFLATE
+
+namespace
+{
+	struct BitReader
+	{
+		const uint8* data;
+		size_t size;
+		size_t position = 0;
+		uint32 bitBuffer = 0;
+		int32 bitCount = 0;
+
+		// Reading past the end yields zeros, callers check IsOverrun once a block is done
+		uint32 ReadBits(int32 count)
+		{
+			while (bitCount < count)
+			{
+				const uint32 byte = position < size ? data[position] : 0;
+				position++;
+				bitBuffer |= byte << bitCount;
+				bitCount += 8;
+			}
+			const uint32 value = bitBuffer & ((1u << count) - 1);
+			bitBuffer >>= count;
+			bitCount -= count;
+			return value;
+		}
+
+		// Fills the buffer with whatever bytes are left without reading past the end, missing bits are zero
+		uint32 PeekBits(int32 count)
+		{
+			while (bitCount < count && position < size)
+			{
+				bitBuffer |= static_cast<uint32>(data[position]) << bitCount;
+				position++;
+				bitCount += 8;
+			}
+			return bitBuffer & ((1u << count) - 1);
+		}
+
+		// Only for bits PeekBits has already buffered
+		void DropBits(int32 count)
+		{
+			bitBuffer >>= count;
+			bitCount -= count;
+		}
+
+		// Whole bytes that were buffered ahead go back to the stream
+		void AlignToByte()
+		{
+			position -= bitCount / 8;
+			bitBuffer = 0;
+			bitCount = 0;
+		}
+
+		bool IsOverrun() const { return position > size; }
+	};
+
+	// Canonical huffman code. Codes up to FastBits long, which is nearly all of them, come from a lookup table,
+	// longer ones are decoded one bit at a time by walking the code lengths (zlib's "puff" approach).
+	struct Huffman
+	{
+		static constexpr int32 FastBits = 9;
+
+		uint16 counts[16];
+		uint16 symbols[288];
+		// Indexed by the next FastBits bits of the stream, symbol << 4 | code length, 0 when the code is longer
+		uint16 fastTable[1 << FastBits];
+
+		bool Build(const uint8* lengths, int32 symbolCount)
+		{
+			std::memset(counts, 0, sizeof(counts));
+			for (int32 i = 0; i < symbolCount; i++)
+			{
+				counts[lengths[i]]++;
+			}
+			counts[0] = 0;
+
+			// Over subscribed codes are invalid, incomplete ones are allowed (single distance code)
+			int32 left = 1;
+			for (int32 length = 1; length < 16; length++)
+			{
+				left <<= 1;
+				left -= counts[length];
+				if (left < 0)
+				{
+					return false;
+				}
+			}
+
+			uint16 offsets[16];
+			offsets[1] = 0;
+			for (int32 length = 1; length < 15; length++)
+			{
+				offsets[length + 1] = offsets[length] + counts[length];
+			}
+			for (int32 i = 0; i < symbolCount; i++)
+			{
+				if (lengths[i] != 0)
+				{
+					symbols[offsets[lengths[i]]++] = static_cast<uint16>(i);
+				}
+			}
+
+			// Codes of one length are consecutive in symbol order, the stream holds them most significant bit first
+			std::memset(fastTable, 0, sizeof(fastTable));
+			uint32 nextCode[16];
+			uint32 code = 0;
+			for (int32 length = 1; length < 16; length++)
+			{
+				code = (code + counts[length - 1]) << 1;
+				nextCode[length] = code;
+			}
+			for (int32 i = 0; i < symbolCount; i++)
+			{
+				const int32 length = lengths[i];
+				if (length == 0 || length > FastBits)
+				{
+					continue;
+				}
+				const uint32 symbolCode = nextCode[length]++;
+				uint32 reversed = 0;
+				for (int32 bit = 0; bit < length; bit++)
+				{
+					reversed |= ((symbolCode >> bit) & 1) << (length - 1 - bit);
+				}
+				for (uint32 index = reversed; index < (1u << FastBits); index += 1u << length)
+				{
+					fastTable[index] = static_cast<uint16>((i << 4) | length);
+				}
+			}
+			return true;
+		}
+
+		int32 Decode(BitReader& reader) const
+		{
+			const uint16 entry = fastTable[reader.PeekBits(FastBits)];
+			const int32 entryLength = entry & 0xF;
+			if (entry != 0 && entryLength <= reader.bitCount)
+			{
+				reader.DropBits(entryLength);
+				return entry >> 4;
+			}
+
+			int32 code = 0;
+			int32 first = 0;
+			int32 index = 0;
+			for (int32 length = 1; length < 16; length++)
+			{
+				code |= static_cast<int32>(reader.ReadBits(1));
+				const int32 count = counts[length];
+				if (code - count < first)
+				{
+					return symbols[index + (code - first)];
+				}
+				index += count;
+				first += count;
+				first <<= 1;
+				code <<= 1;
+			}
+			return -1;
+		}
+	};
+
+	const uint16 LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8 LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16 DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8 DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	bool InflateCodes(BitReader& reader, const Huffman& lengthCodes, const Huffman& distanceCodes, std::vector<uint8>& out, size_t outStart)
+	{
+		while (true)
+		{
+			const int32 symbol = lengthCodes.Decode(reader);
+			if (symbol < 0 || reader.IsOverrun())
+			{
+				return false;
+			}
+			if (symbol < 256)
+			{
+				out.push_back(static_cast<uint8>(symbol));
+				continue;
+			}
+			if (symbol == 256)
+			{
+				return true;
+			}
+
+			const int32 lengthIndex = symbol - 257;
+			if (lengthIndex >= 29)
+			{
+				return false;
+			}
+			const size_t length = LengthBase[lengthIndex] + reader.ReadBits(LengthExtra[lengthIndex]);
+
+			const int32 distanceIndex = distanceCodes.Decode(reader);
+			if (distanceIndex < 0 || distanceIndex >= 30)
+			{
+				return false;
+			}
+			const size_t distance = DistanceBase[distanceIndex] + reader.ReadBits(DistanceExtra[distanceIndex]);
+			if (distance > out.size() - outStart)
+			{
+				return false;
+			}
+
+			// Byte by byte, the copy can overlap with what it writes
+			const size_t to = out.size();
+			out.resize(to + length);
+			uint8* copy = out.data() + to;
+			for (size_t i = 0; i < length; i++)
+			{
+				copy[i] = copy[i - distance];
+			}
+		}
+	}
+
+	bool InflateDynamicTables(BitReader& reader, Huffman& lengthCodes, Huffman& distanceCodes)
+	{
+		static const uint8 CodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		const int32 lengthCount = static_cast<int32>(reader.ReadBits(5)) + 257;
+		const int32 distanceCount = static_cast<int32>(reader.ReadBits(5)) + 1;
+		const int32 codeLengthCount = static_cast<int32>(reader.ReadBits(4)) + 4;
+		if (lengthCount > 286 || distanceCount > 30)
+		{
+			return false;
+		}
+
+		uint8 lengths[320] = {};
+		for (int32 i = 0; i < codeLengthCount; i++)
+		{
+			lengths[CodeLengthOrder[i]] = static_cast<uint8>(reader.ReadBits(3));
+		}
+		Huffman codeLengthCodes;
+		if (!codeLengthCodes.Build(lengths, 19))
+		{
+			return false;
+		}
+
+		int32 index = 0;
+		while (index < lengthCount + distanceCount)
+		{
+			const int32 symbol = codeLengthCodes.Decode(reader);
+			if (symbol < 0)
+			{
+				return false;
+			}
+			if (symbol < 16)
+			{
+				lengths[index++] = static_cast<uint8>(symbol);
+				continue;
+			}
+
+			uint8 repeatedLength = 0;
+			int32 repeat = 0;
+			if (symbol == 16)
+			{
+				if (index == 0)
+				{
+					return false;
+				}
+				repeatedLength = lengths[index - 1];
+				repeat = 3 + static_cast<int32>(reader.ReadBits(2));
+			}
+			else if (symbol == 17)
+			{
+				repeat = 3 + static_cast<int32>(reader.ReadBits(3));
+			}
+			else
+			{
+				repeat = 11 + static_cast<int32>(reader.ReadBits(7));
+			}
+			if (index + repeat > lengthCount + distanceCount)
+			{
+				return false;
+			}
+			while (repeat-- > 0)
+			{
+				lengths[index++] = repeatedLength;
+			}
+		}
+
+		// Without an end of block code nothing can be decoded
+		if (lengths[256] == 0)
+		{
+			return false;
+		}
+		return lengthCodes.Build(lengths, lengthCount) && distanceCodes.Build(lengths + lengthCount, distanceCount);
+	}
+}
+
+bool Inflate(const uint8* data, size_t size, std::vector<uint8>& outData)
+{
+	// zlib header: deflate, window <= 32k, no preset dictionary, checksum over the first two bytes
+	if (size < 2 || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || (data[1] & 0x20) != 0 || ((data[0] << 8) | data[1]) % 31 != 0)
+	{
+		return false;
+	}
+
+	BitReader reader { data + 2, size - 2 };
+	const size_t outStart = outData.size();
+
+	bool bLastBlock = false;
+	while (!bLastBlock)
+	{
+		bLastBlock = reader.ReadBits(1) != 0;
+		const uint32 blockType = reader.ReadBits(2);
+
+		if (blockType == 0)
+		{
+			reader.AlignToByte();
+			if (reader.position + 4 > reader.size)
+			{
+				return false;
+			}
+			const uint8* header = reader.data + reader.position;
+			const uint32 length = header[0] | (header[1] << 8);
+			const uint32 inverseLength = header[2] | (header[3] << 8);
+			reader.position += 4;
+			if (length != (~inverseLength & 0xFFFF) || reader.position + length > reader.size)
+			{
+				return false;
+			}
+			outData.insert(outData.end(), reader.data + reader.position, reader.data + reader.position + length);
+			reader.position += length;
+		}
+		else if (blockType == 1)
+		{
+			static Huffman fixedLengthCodes;
+			static Huffman fixedDistanceCodes;
+			static const bool bFixedBuilt = []
+			{
+				uint8 lengths[288];
+				std::memset(lengths, 8, 144);
+				std::memset(lengths + 144, 9, 112);
+				std::memset(lengths + 256, 7, 24);
+				std::memset(lengths + 280, 8, 8);
+				fixedLengthCodes.Build(lengths, 288);
+				std::memset(lengths, 5, 30);
+				fixedDistanceCodes.Build(lengths, 30);
+				return true;
+			}();
+			(void)bFixedBuilt;
+
+			if (!InflateCodes(reader, fixedLengthCodes, fixedDistanceCodes, outData, outStart))
+			{
+				return false;
+			}
+		}
+		else if (blockType == 2)
+		{
+			Huffman lengthCodes;
+			Huffman distanceCodes;
+			if (!InflateDynamicTables(reader, lengthCodes, distanceCodes) || !InflateCodes(reader, lengthCodes, distanceCodes, outData, outStart))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		if (reader.IsOverrun())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// ~INFLATE
+
+// PNG
+
+static uint32 ReadBigEndian(const uint8* data)
+{
+	return (static_cast<uint32>(data[0]) << 24) | (static_cast<uint32>(data[1]) << 16) | (static_cast<uint32>(data[2]) << 8) | data[3];
+}
+
+static uint8 PaethPredictor(int32 left, int32 up, int32 upLeft)
+{
+	const int32 estimate = left + up - upLeft;
+	const int32 distanceLeft = std::abs(estimate - left);
+	const int32 distanceUp = std::abs(estimate - up);
+	const int32 distanceUpLeft = std::abs(estimate - upLeft);
+	if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft)
+	{
+		return static_cast<uint8>(left);
+	}
+	return static_cast<uint8>(distanceUp <= distanceUpLeft ? up : upLeft);
+}
+
+// Reverses the per row filters in place, rows are 1 filter byte followed by rowBytes of data.
+// The first row is unfiltered against a row of zeros.
+static bool Unfilter(uint8* data, int32 height, size_t rowBytes, int32 bytesPerPixel)
+{
+	const std::vector<uint8> zeroRow(rowBytes, 0);
+	const uint8* previousRow = zeroRow.data();
+	const size_t pixelBytes = static_cast<size_t>(bytesPerPixel);
+	for (int32 y = 0; y < height; y++)
+	{
+		uint8* row = data + y * (rowBytes + 1);
+		const uint8 filter = row[0];
+		row++;
+
+		// The first pixel has no left neighbour, after that every filter only looks back pixelBytes
+		switch (filter)
+		{
+		case 0:
+			break;
+		case 1:
+			for (size_t i = pixelBytes; i < rowBytes; i++)
+			{
+				row[i] = static_cast<uint8>(row[i] + row[i - pixelBytes]);
+			}
+			break;
+		case 2:
+			for (size_t i = 0; i < rowBytes; i++)
+			{
+				row[i] = static_cast<uint8>(row[i] + previousRow[i]);
+			}
+			break;
+		case 3:
+			for (size_t i = 0; i < std::min(pixelBytes, rowBytes); i++)
+			{
+				row[i] = static_cast<uint8>(row[i] + (previousRow[i] >> 1));
+			}
+			for (size_t i = pixelBytes; i < rowBytes; i++)
+			{
+				row[i] = static_cast<uint8>(row[i] + ((row[i - pixelBytes] + previousRow[i]) >> 1));
+			}
+			break;
+		case 4:
+			for (size_t i = 0; i < std::min(pixelBytes, rowBytes); i++)
+			{
+				row[i] = static_cast<uint8>(row[i] + previousRow[i]);
+			}
+			for (size_t i = pixelBytes; i < rowBytes; i++)
+			{
+				row[i] = static_cast<uint8>(row[i] + PaethPredictor(row[i - pixelBytes], previousRow[i], previousRow[i - pixelBytes]));
+			}
+			break;
+		default:
+			return false;
+		}
+		previousRow = row;
+	}
+	return true;
+}
+
+PngError DecodePng(const uint8* data, size_t size, DecodedPng& outImage)
+{
+	static const uint8 Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	if (size < 8 || std::memcmp(data, Signature, 8) != 0)
+	{
+		return PngError::NotPng;
+	}
+
+	int32 width = 0;
+	int32 height = 0;
+	int32 bitDepth = 0;
+	int32 colorType = -1;
+	uint32 palette[256];
+	std::fill(palette, palette + 256, 0xFF000000);
+	int32 paletteSize = 0;
+	// Color that is fully transparent for gray and rgb images without alpha, in the bit depth of the image
+	int32 transparentGray = -1;
+	int32 transparentRgb[3] = { -1, -1, -1 };
+	std::vector<uint8> compressed;
+
+	size_t position = 8;
+	bool bEnd = false;
+	while (!bEnd && position + 12 <= size)
+	{
+		const uint32 length = ReadBigEndian(data + position);
+		const uint8* type = data + position + 4;
+		const uint8* chunk = data + position + 8;
+		if (length > size - position - 12)
+		{
+			return PngError::Corrupt;
+		}
+
+		if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13)
+		{
+			width = static_cast<int32>(ReadBigEndian(chunk));
+			height = static_cast<int32>(ReadBigEndian(chunk + 4));
+			bitDepth = chunk[8];
+			colorType = chunk[9];
+			// Compression and filter method 0 are the only ones defined, interlacing is not supported
+			if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0)
+			{
+				return PngError::Unsupported;
+			}
+		}
+		else if (std::memcmp(type, "PLTE", 4) == 0)
+		{
+			paletteSize = std::min<int32>(static_cast<int32>(length / 3), 256);
+			for (int32 i = 0; i < paletteSize; i++)
+			{
+				palette[i] = 0xFF000000 | (chunk[i * 3] << 16) | (chunk[i * 3 + 1] << 8) | chunk[i * 3 + 2];
+			}
+		}
+		else if (std::memcmp(type, "tRNS", 4) == 0)
+		{
+			if (colorType == 3)
+			{
+				for (uint32 i = 0; i < length && i < 256; i++)
+				{
+					palette[i] = (palette[i] & 0x00FFFFFF) | (static_cast<uint32>(chunk[i]) << 24);
+				}
+			}
+			else if (colorType == 0 && length >= 2)
+			{
+				transparentGray = (chunk[0] << 8) | chunk[1];
+			}
+			else if (colorType == 2 && length >= 6)
+			{
+				for (int32 i = 0; i < 3; i++)
+				{
+					transparentRgb[i] = (chunk[i * 2] << 8) | chunk[i * 2 + 1];
+				}
+			}
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0)
+		{
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0)
+		{
+			bEnd = true;
+		}
+
+		position += length + 12;
+	}
+
+	int32 channels = 0;
+	switch (colorType)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	// No IHDR at all, or a color type the spec doesn't define
+	default: return colorType < 0 ? PngError::Corrupt : PngError::Unsupported;
+	}
+	const bool bValidDepth = bitDepth == 8 || (bitDepth == 16 && colorType != 3) || ((bitDepth == 1 || bitDepth == 2 || bitDepth == 4) && (colorType == 0 || colorType == 3));
+	if (!bValidDepth || width > (1 << 16) || height > (1 << 16))
+	{
+		return PngError::Unsupported;
+	}
+	if (width <= 0 || height <= 0 || (colorType == 3 && paletteSize == 0))
+	{
+		return PngError::Corrupt;
+	}
+
+	const size_t rowBytes = (static_cast<size_t>(width) * channels * bitDepth + 7) / 8;
+	std::vector<uint8> filtered;
+	filtered.reserve((rowBytes + 1) * height);
+	if (!Inflate(compressed.data(), compressed.size(), filtered) || filtered.size() < (rowBytes + 1) * height)
+	{
+		return PngError::Corrupt;
+	}
+
+	const int32 bytesPerPixel = std::max(1, channels * bitDepth / 8);
+	if (!Unfilter(filtered.data(), height, rowBytes, bytesPerPixel))
+	{
+		return PngError::Corrupt;
+	}
+
+	outImage.width = width;
+	outImage.height = height;
+	outImage.pixels.resize(static_cast<size_t>(width) * height);
+
+	const int32 sampleMax = (1 << bitDepth) - 1;
+	for (int32 y = 0; y < height; y++)
+	{
+		const uint8* row = filtered.data() + y * (rowBytes + 1) + 1;
+		uint32* outRow = outImage.pixels.data() + static_cast<size_t>(y) * width;
+
+		// 8 bit rgba is what every asset is exported as, skip the generic sample path for it
+		if (colorType == 6 && bitDepth == 8)
+		{
+			for (int32 x = 0; x < width; x++)
+			{
+				const uint8* rgba = row + x * 4;
+				outRow[x] = (static_cast<uint32>(rgba[3]) << 24) | (rgba[0] << 16) | (rgba[1] << 8) | rgba[2];
+			}
+			continue;
+		}
+
+		// Sample c of pixel x at the bit depth of the image
+		auto sample = [&](int32 x, int32 c) -> int32
+		{
+			const size_t index = static_cast<size_t>(x) * channels + c;
+			if (bitDepth == 8)
+			{
+				return row[index];
+			}
+			if (bitDepth == 16)
+			{
+				return (row[index * 2] << 8) | row[index * 2 + 1];
+			}
+			const size_t bit = index * bitDepth;
+			return (row[bit / 8] >> (8 - bitDepth - bit % 8)) & sampleMax;
+		};
+		// Scales a sample to 8 bits
+		auto to8 = [&](int32 value) -> uint32
+		{
+			return bitDepth == 16 ? static_cast<uint32>(value >> 8) : static_cast<uint32>(value * 255 / sampleMax);
+		};
+
+		for (int32 x = 0; x < width; x++)
+		{
+			uint32 color = 0;
+			switch (colorType)
+			{
+			case 0:
+			{
+				const int32 gray = sample(x, 0);
+				const uint32 value = to8(gray);
+				color = (gray == transparentGray ? 0 : 0xFF000000) | (value << 16) | (value << 8) | value;
+				break;
+			}
+			case 2:
+			{
+				const int32 r = sample(x, 0);
+				const int32 g = sample(x, 1);
+				const int32 b = sample(x, 2);
+				const bool bTransparent = r == transparentRgb[0] && g == transparentRgb[1] && b == transparentRgb[2];
+				color = (bTransparent ? 0 : 0xFF000000) | (to8(r) << 16) | (to8(g) << 8) | to8(b);
+				break;
+			}
+			case 3:
+				color = palette[sample(x, 0)];
+				break;
+			case 4:
+			{
+				const uint32 value = to8(sample(x, 0));
+				color = (to8(sample(x, 1)) << 24) | (value << 16) | (value << 8) | value;
+				break;
+			}
+			case 6:
+				color = (to8(sample(x, 3)) << 24) | (to8(sample(x, 0)) << 16) | (to8(sample(x, 1)) << 8) | to8(sample(x, 2));
+				break;
+			}
+			outRow[x] = color;
+		}
+	}
+	return PngError::None;
+}
+
+PngError LoadPng(const std::string& path, DecodedPng& outImage)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return PngError::FileNotFound;
+	}
+	// One read of the whole file, going through stream iterators costs about as much as the decode
+	std::vector<uint8> bytes(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+	return DecodePng(bytes.data(), file ? bytes.size() : 0, outImage);
+}
+
+std::vector<PngError> LoadPngs(const std::vector<std::string>& paths, std::vector<DecodedPng>& outImages, uint32 threadCount)
+{
+	std::vector<PngError> errors(paths.size(), PngError::None);
+	outImages.assign(paths.size(), DecodedPng {});
+
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threadCount = std::min(threadCount, static_cast<uint32>(paths.size()));
+
+	// Files differ a lot in size, so every worker grabs the next path instead of getting a fixed slice
+	std::atomic<size_t> nextIndex { 0 };
+	auto work = [&]()
+	{
+		for (size_t index = nextIndex++; index < paths.size(); index = nextIndex++)
+		{
+			errors[index] = LoadPng(paths[index], outImages[index]);
+		}
+	};
+
+	// The calling thread is one of the workers
+	std::vector<std::thread> workers;
+	for (uint32 i = 1; i < threadCount; i++)
+	{
+		workers.emplace_back(work);
+	}
+	work();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	return errors;
+}
+
+const char* GetPngErrorName(PngError error)
+{
+	switch (error)
+	{
+	case PngError::None: return "none";
+	case PngError::FileNotFound: return "file not found";
+	case PngError::NotPng: return "not a png";
+	case PngError::Unsupported: return "unsupported png";
+	case PngError::Corrupt: return "corrupt png";
+	}
+	return "unknown";
+}
+
+// ~PNG
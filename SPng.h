@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Small png decoder that doesn't depend on any platform image library.
+// Supports every color type at bit depths 1 to 16 with transparency (tRNS), interlaced images are not supported.
+
+struct DecodedPng
+{
+	int32 width = 0;
+	int32 height = 0;
+	// 0xAARRGGBB, width * height tightly packed rows
+	std::vector<uint32> pixels;
+};
+
+enum class PngError : uint8
+{
+	None,
+	FileNotFound,
+	// The signature is missing, the file is something else
+	NotPng,
+	// Valid png that uses a feature the decoder leaves out, like interlacing
+	Unsupported,
+	// Truncated or damaged chunks, image data or compressed stream
+	Corrupt,
+};
+
+const char* GetPngErrorName(PngError error);
+
+PngError DecodePng(const uint8* data, size_t size, DecodedPng& outImage);
+PngError LoadPng(const std::string& path, DecodedPng& outImage);
+
+// Loads every path on a pool of worker threads, one per core when threadCount is 0.
+// outImages and the returned errors line up with paths, a failed image is left empty.
+std::vector<PngError> LoadPngs(const std::vector<std::string>& paths, std::vector<DecodedPng>& outImages, uint32 threadCount = 0);
+
+// zlib stream (rfc 1950/1951) into outData, which keeps whatever it held before
+bool Inflate(const uint8* data, size_t size, std::vector<uint8>& outData);
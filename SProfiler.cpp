@@ -0,0 +1,127 @@
+#include "SProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std::chrono;
+
+std::atomic<bool> bProfilerEnabled { false };
+
+static const steady_clock::time_point profilerEpoch = steady_clock::now();
+
+struct ProfileEvent
+{
+	const char* name;
+	uint64 startNs;
+	uint64 endNs;
+};
+
+// Zones of one thread, oldest get overwritten once it is full
+struct ProfileThreadBuffer
+{
+	static constexpr uint32 Capacity = 1 << 16;
+
+	std::vector<ProfileEvent> events = std::vector<ProfileEvent>(Capacity);
+	uint64 writeCount = 0;
+	uint32 threadId = 0;
+};
+
+// Buffers are owned here and not by the thread, so zones of threads that already exited can still be exported
+static std::mutex threadBuffersMutex;
+static std::vector<std::unique_ptr<ProfileThreadBuffer>> threadBuffers;
+
+static ProfileThreadBuffer& GetThreadBuffer()
+{
+	thread_local ProfileThreadBuffer* buffer = nullptr;
+	if (buffer == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(threadBuffersMutex);
+		threadBuffers.push_back(std::make_unique<ProfileThreadBuffer>());
+		buffer = threadBuffers.back().get();
+		buffer->threadId = static_cast<uint32>(threadBuffers.size());
+	}
+	return *buffer;
+}
+
+void SetProfilerEnabled(bool bEnabled)
+{
+	bProfilerEnabled.store(bEnabled, std::memory_order_relaxed);
+}
+
+bool IsProfilerEnabled()
+{
+	return bProfilerEnabled.load(std::memory_order_relaxed);
+}
+
+uint64 GetProfilerTimeNs()
+{
+	return static_cast<uint64>(duration_cast<nanoseconds>(steady_clock::now() - profilerEpoch).count());
+}
+
+void RecordProfileZone(const char* name, uint64 startNs, uint64 endNs)
+{
+	ProfileThreadBuffer& buffer = GetThreadBuffer();
+	buffer.events[buffer.writeCount % ProfileThreadBuffer::Capacity] = ProfileEvent { name, startNs, endNs };
+	buffer.writeCount++;
+}
+
+// Zone names are code literals, but escape them anyway so a stray quote can't break the json
+static void WriteJsonString(FILE* file, const char* text)
+{
+	std::fputc('"', file);
+	for (const char* c = text; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			std::fputc('\\', file);
+		}
+		std::fputc(*c, file);
+	}
+	std::fputc('"', file);
+}
+
+bool ExportProfilerTrace(const std::string& path)
+{
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+	std::fputs("{\"traceEvents\":[\n", file);
+	bool bFirst = true;
+	for (const std::unique_ptr<ProfileThreadBuffer>& buffer : threadBuffers)
+	{
+		const uint64 count = std::min<uint64>(buffer->writeCount, ProfileThreadBuffer::Capacity);
+		for (uint64 i = buffer->writeCount - count; i < buffer->writeCount; i++)
+		{
+			const ProfileEvent& event = buffer->events[i % ProfileThreadBuffer::Capacity];
+
+			// Complete events, timestamps in microseconds
+			std::fputs(bFirst ? "" : ",\n", file);
+			std::fputs("{\"name\":", file);
+			WriteJsonString(file, event.name);
+			std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				buffer->threadId, event.startNs / 1000.0, (event.endNs - event.startNs) / 1000.0);
+			bFirst = false;
+		}
+	}
+	std::fputs("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+
+	return std::fclose(file) == 0;
+}
+
+void ClearProfilerZones()
+{
+	std::lock_guard<std::mutex> lock(threadBuffersMutex);
+	for (const std::unique_ptr<ProfileThreadBuffer>& buffer : threadBuffers)
+	{
+		buffer->writeCount = 0;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <atomic>
+#include <string>
+
+// Scoped timing zones for finding out where frame time goes.
+// Every thread records into its own ring buffer, only the oldest zones get lost when a buffer wraps.
+// Zones cost one relaxed load while the profiler is disabled, build with SDRAW_PROFILE=0 to compile them out.
+//
+// void Update(float deltaTime)
+// {
+//     SPROFILE_SCOPE("Update");
+//     ...
+// }
+
+#ifndef SDRAW_PROFILE
+#define SDRAW_PROFILE 1
+#endif
+
+void SetProfilerEnabled(bool bEnabled);
+bool IsProfilerEnabled();
+
+// Nanoseconds since the program started
+uint64 GetProfilerTimeNs();
+
+// Writes all recorded zones of all threads as chrome trace_event json (chrome://tracing, ui.perfetto.dev).
+// Only call while no thread is recording, e.g. after disabling the profiler.
+bool ExportProfilerTrace(const std::string& path);
+void ClearProfilerZones();
+
+// Internal, appends a finished zone to the ring buffer of the calling thread
+void RecordProfileZone(const char* name, uint64 startNs, uint64 endNs);
+extern std::atomic<bool> bProfilerEnabled;
+
+class ProfileZone
+{
+public:
+	// name has to outlive the profiler, string literals are fine
+	explicit ProfileZone(const char* inName)
+		: name(bProfilerEnabled.load(std::memory_order_relaxed) ? inName : nullptr)
+		, startNs(name != nullptr ? GetProfilerTimeNs() : 0)
+	{
+	}
+
+	~ProfileZone()
+	{
+		if (name != nullptr)
+		{
+			RecordProfileZone(name, startNs, GetProfilerTimeNs());
+		}
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* name;
+	uint64 startNs;
+};
+
+#if SDRAW_PROFILE
+#define SPROFILE_CONCAT_INNER(a, b) a##b
+#define SPROFILE_CONCAT(a, b) SPROFILE_CONCAT_INNER(a, b)
+#define SPROFILE_SCOPE(name) ProfileZone SPROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define SPROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,324 @@
+#include "SRaster.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SRASTER_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SRASTER_SSE2 1
+#endif
+
+SRasterTarget MakeRasterTarget(uint32* pixels, int32 width, int32 height)
+{
+	return SRasterTarget { pixels, width, height, width, 0, 0, width, height };
+}
+
+static void FillSpanScalar(uint32* dest, int32 count, uint32 color)
+{
+	for (int32 i = 0; i < count; i++)
+	{
+		dest[i] = color;
+	}
+}
+
+void FillSpan(uint32* dest, int32 count, uint32 color)
+{
+#if SRASTER_AVX2
+	// Scalar until the destination is 32 byte aligned, then 16 pixels per iteration with aligned stores
+	while (count > 0 && (reinterpret_cast<uintptr_t>(dest) & 31) != 0)
+	{
+		*dest++ = color;
+		count--;
+	}
+
+	const __m256i wideColor = _mm256_set1_epi32(static_cast<int>(color));
+	while (count >= 16)
+	{
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dest), wideColor);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dest + 8), wideColor);
+		dest += 16;
+		count -= 16;
+	}
+	if (count >= 8)
+	{
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dest), wideColor);
+		dest += 8;
+		count -= 8;
+	}
+#elif SRASTER_SSE2
+	// Scalar until the destination is 16 byte aligned, then 8 pixels per iteration with aligned stores
+	while (count > 0 && (reinterpret_cast<uintptr_t>(dest) & 15) != 0)
+	{
+		*dest++ = color;
+		count--;
+	}
+
+	const __m128i wideColor = _mm_set1_epi32(static_cast<int>(color));
+	while (count >= 8)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(dest), wideColor);
+		_mm_store_si128(reinterpret_cast<__m128i*>(dest + 4), wideColor);
+		dest += 8;
+		count -= 8;
+	}
+	if (count >= 4)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(dest), wideColor);
+		dest += 4;
+		count -= 4;
+	}
+#endif
+
+	FillSpanScalar(dest, count, color);
+}
+
+void FillHorizontalSpan(const SRasterTarget& target, int32 startX, int32 endX, int32 y, uint32 color)
+{
+	if (y < target.clipMinY || y >= target.clipMaxY)
+	{
+		return;
+	}
+
+	startX = std::max(startX, target.clipMinX);
+	endX = std::min(endX, target.clipMaxX - 1);
+	if (startX > endX)
+	{
+		return;
+	}
+
+	FillSpan(target.GetRow(y) + startX, endX - startX + 1, color);
+}
+
+// Integer ceil(numerator / denominator) for a positive denominator
+static int64 DivideRoundUp(int64 numerator, int64 denominator)
+{
+	const int64 quotient = numerator / denominator;
+	return quotient * denominator < numerator ? quotient + 1 : quotient;
+}
+
+// Pixel i of a line is i steps along the major axis and floor((2 * i * minorDelta + majorDelta) / (2 * majorDelta))
+// steps along the minor one, what Bresenham walks to. That makes the first and last step inside the clip rectangle
+// a division each, and the walk starts there with the matching error term.
+static void DrawLineClipped(const SRasterTarget& target, int32 startX, int32 startY, int32 endX, int32 endY, uint32 color, bool bSkipStart)
+{
+	const int32 stepX = startX < endX ? 1 : -1;
+	const int32 stepY = startY < endY ? 1 : -1;
+	const int32 deltaX = std::abs(endX - startX);
+	const int32 deltaY = std::abs(endY - startY);
+	const int32 firstStep = bSkipStart ? 1 : 0;
+
+	if (deltaY == 0)
+	{
+		const int32 first = startX + firstStep * stepX;
+		if (deltaX >= firstStep)
+		{
+			FillHorizontalSpan(target, std::min(first, endX), std::max(first, endX), startY, color);
+		}
+		return;
+	}
+	if (deltaX == 0)
+	{
+		if (startX < target.clipMinX || startX >= target.clipMaxX)
+		{
+			return;
+		}
+		const int32 first = startY + firstStep * stepY;
+		const int32 minY = std::max(std::min(first, endY), target.clipMinY);
+		const int32 maxY = std::min(std::max(first, endY), target.clipMaxY - 1);
+		if (minY > maxY)
+		{
+			return;
+		}
+		uint32* pixel = target.GetRow(minY) + startX;
+		for (int32 y = minY; y <= maxY; y++, pixel += target.pitch)
+		{
+			*pixel = color;
+		}
+		return;
+	}
+
+	const bool bMajorX = deltaX >= deltaY;
+	const int32 majorDelta = bMajorX ? deltaX : deltaY;
+	const int32 minorDelta = bMajorX ? deltaY : deltaX;
+	const int32 majorStart = bMajorX ? startX : startY;
+	const int32 minorStart = bMajorX ? startY : startX;
+	const int32 majorStep = bMajorX ? stepX : stepY;
+	const int32 minorStep = bMajorX ? stepY : stepX;
+	const int32 majorClipMin = bMajorX ? target.clipMinX : target.clipMinY;
+	const int32 majorClipMax = bMajorX ? target.clipMaxX : target.clipMaxY;
+	const int32 minorClipMin = bMajorX ? target.clipMinY : target.clipMinX;
+	const int32 minorClipMax = bMajorX ? target.clipMaxY : target.clipMaxX;
+
+	// Steps along each axis that stay inside the clip rectangle
+	int64 firstMajor = majorStep > 0 ? majorClipMin - majorStart : majorStart - (majorClipMax - 1);
+	int64 lastMajor = majorStep > 0 ? majorClipMax - 1 - majorStart : majorStart - majorClipMin;
+	const int64 firstMinor = minorStep > 0 ? minorClipMin - minorStart : minorStart - (minorClipMax - 1);
+	const int64 lastMinor = minorStep > 0 ? minorClipMax - 1 - minorStart : minorStart - minorClipMin;
+
+	// Minor steps only grow with i, so first and last minor step bound i as well
+	const int64 doubleMajor = 2 * static_cast<int64>(majorDelta);
+	const int64 doubleMinor = 2 * static_cast<int64>(minorDelta);
+	firstMajor = std::max({ firstMajor, static_cast<int64>(firstStep), DivideRoundUp((2 * firstMinor - 1) * majorDelta, doubleMinor) });
+	lastMajor = std::min({ lastMajor, static_cast<int64>(majorDelta), DivideRoundUp((2 * lastMinor + 1) * majorDelta, doubleMinor) - 1 });
+	if (firstMajor > lastMajor)
+	{
+		return;
+	}
+
+	const int64 numerator = firstMajor * doubleMinor + majorDelta;
+	const int32 x = static_cast<int32>(startX + (bMajorX ? firstMajor : numerator / doubleMajor) * stepX);
+	const int32 y = static_cast<int32>(startY + (bMajorX ? numerator / doubleMajor : firstMajor) * stepY);
+	int64 error = numerator % doubleMajor;
+
+	const int32 pixelStepX = stepX;
+	const int32 pixelStepY = stepY * target.pitch;
+	const int32 majorPixelStep = bMajorX ? pixelStepX : pixelStepY;
+	const int32 minorPixelStep = bMajorX ? pixelStepY : pixelStepX;
+	uint32* pixel = target.GetRow(y) + x;
+	for (int64 i = firstMajor; i < lastMajor; i++)
+	{
+		*pixel = color;
+		pixel += majorPixelStep;
+		error += doubleMinor;
+		if (error >= doubleMajor)
+		{
+			error -= doubleMajor;
+			pixel += minorPixelStep;
+		}
+	}
+	*pixel = color;
+}
+
+void DrawLine(const SRasterTarget& target, int32 startX, int32 startY, int32 endX, int32 endY, uint32 color)
+{
+	DrawLineClipped(target, startX, startY, endX, endY, color, false);
+}
+
+void DrawPolyline(const SRasterTarget& target, const RasterPoint* points, int32 count, uint32 color)
+{
+	if (count == 1)
+	{
+		DrawLineClipped(target, points[0].x, points[0].y, points[0].x, points[0].y, color, false);
+	}
+	for (int32 i = 1; i < count; i++)
+	{
+		DrawLineClipped(target, points[i - 1].x, points[i - 1].y, points[i].x, points[i].y, color, i > 1);
+	}
+}
+
+void FillRect(const SRasterTarget& target, int32 x, int32 y, int32 width, int32 height, uint32 color)
+{
+	const int32 startX = std::max(x, target.clipMinX);
+	const int32 startY = std::max(y, target.clipMinY);
+	const int32 endX = std::min(x + width, target.clipMaxX);
+	const int32 endY = std::min(y + height, target.clipMaxY);
+	if (startX >= endX || startY >= endY)
+	{
+		return;
+	}
+
+	// Rows of a full width rect are contiguous, fill them as one span
+	if (startX == 0 && endX == target.width && target.pitch == target.width)
+	{
+		FillSpan(target.GetRow(startY), (endY - startY) * target.width, color);
+		return;
+	}
+
+	for (int32 row = startY; row < endY; row++)
+	{
+		FillSpan(target.GetRow(row) + startX, endX - startX, color);
+	}
+}
+
+void ComputeCircleHalfWidths(int32 radius, int32* outHalfWidths)
+{
+	std::fill(outHalfWidths, outHalfWidths + radius + 1, -1);
+
+	int32 offsetX = 0;
+	int32 offsetY = radius;
+	int32 d = radius - 1;
+
+	while (offsetY >= offsetX)
+	{
+		outHalfWidths[offsetX] = std::max(outHalfWidths[offsetX], offsetY);
+		outHalfWidths[offsetY] = std::max(outHalfWidths[offsetY], offsetX);
+
+		if (d >= 2 * offsetX)
+		{
+			d -= 2 * offsetX + 1;
+			offsetX += 1;
+		}
+		else if (d < 2 * (radius - offsetY))
+		{
+			d += 2 * offsetY - 1;
+			offsetY -= 1;
+		}
+		else
+		{
+			d += 2 * (offsetY - offsetX - 1);
+			offsetY -= 1;
+			offsetX += 1;
+		}
+	}
+}
+
+void FillCircle(const SRasterTarget& target, int32 centerX, int32 centerY, int32 radius, uint32 color)
+{
+	if (radius < 0)
+	{
+		return;
+	}
+
+	// Kept around so drawing circles doesn't allocate once the largest radius has been seen
+	thread_local std::vector<int32> halfWidths;
+	halfWidths.resize(std::max<size_t>(halfWidths.size(), radius + 1));
+	ComputeCircleHalfWidths(radius, halfWidths.data());
+
+	for (int32 row = 0; row <= radius; row++)
+	{
+		const int32 halfWidth = halfWidths[row];
+		if (halfWidth < 0)
+		{
+			continue;
+		}
+
+		FillHorizontalSpan(target, centerX - halfWidth, centerX + halfWidth, centerY + row, color);
+		if (row != 0)
+		{
+			FillHorizontalSpan(target, centerX - halfWidth, centerX + halfWidth, centerY - row, color);
+		}
+	}
+}
+
+void FillEllipse(const SRasterTarget& target, int32 centerX, int32 centerY, int32 radiusX, int32 radiusY, uint32 color)
+{
+	if (radiusX < 0 || radiusY < 0)
+	{
+		return;
+	}
+
+	// Widest x with x^2 * ry^2 + y^2 * rx^2 <= rx^2 * ry^2, x only shrinks while walking away from the center row
+	const int64 radiusXSquared = static_cast<int64>(radiusX) * radiusX;
+	const int64 radiusYSquared = static_cast<int64>(radiusY) * radiusY;
+	const int64 limit = radiusXSquared * radiusYSquared;
+
+	int32 halfWidth = radiusX;
+	for (int32 row = 0; row <= radiusY; row++)
+	{
+		const int64 rowTerm = static_cast<int64>(row) * row * radiusXSquared;
+		while (halfWidth > 0 && static_cast<int64>(halfWidth) * halfWidth * radiusYSquared + rowTerm > limit)
+		{
+			halfWidth--;
+		}
+
+		FillHorizontalSpan(target, centerX - halfWidth, centerX + halfWidth, centerY + row, color);
+		if (row != 0)
+		{
+			FillHorizontalSpan(target, centerX - halfWidth, centerX + halfWidth, centerY - row, color);
+		}
+	}
+}
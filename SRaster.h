@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// Software span rasterizer shared by the SEngine framebuffer and the SDL renderer.
+// Pixels are 0xAARRGGBB, every filled shape writes each covered scanline exactly once.
+
+struct SRasterTarget
+{
+	uint32* pixels;
+	int32 width;
+	int32 height;
+	// Distance between two rows in pixels
+	int32 pitch;
+
+	// Everything outside [clipMinX, clipMaxX) x [clipMinY, clipMaxY) is left untouched
+	int32 clipMinX;
+	int32 clipMinY;
+	int32 clipMaxX;
+	int32 clipMaxY;
+
+	uint32* GetRow(int32 y) const { return pixels + y * pitch; }
+};
+
+struct RasterPoint
+{
+	int32 x;
+	int32 y;
+};
+
+SRasterTarget MakeRasterTarget(uint32* pixels, int32 width, int32 height);
+
+// Writes count pixels of color, uses AVX2 or SSE2 stores when the compiler targets them
+void FillSpan(uint32* dest, int32 count, uint32 color);
+
+// Fills [startX, endX] inclusive on row y after clipping
+void FillHorizontalSpan(const SRasterTarget& target, int32 startX, int32 endX, int32 y, uint32 color);
+
+// Lines include both end points and are clipped to the clip rectangle up front, the pixels inside it are the same as
+// for the unclipped line. Horizontal and vertical lines are written as spans.
+void DrawLine(const SRasterTarget& target, int32 startX, int32 startY, int32 endX, int32 endY, uint32 color);
+// Connects count points with lines, every shared point is written once
+void DrawPolyline(const SRasterTarget& target, const RasterPoint* points, int32 count, uint32 color);
+
+void FillRect(const SRasterTarget& target, int32 x, int32 y, int32 width, int32 height, uint32 color);
+void FillCircle(const SRasterTarget& target, int32 centerX, int32 centerY, int32 radius, uint32 color);
+void FillEllipse(const SRasterTarget& target, int32 centerX, int32 centerY, int32 radiusX, int32 radiusY, uint32 color);
+
+// Half width of every row of a filled circle, from the center row (index 0) to the top and bottom row (index radius).
+// Uses the same midpoint walk as the outlined circle so both line up. outHalfWidths must hold radius + 1 entries.
+void ComputeCircleHalfWidths(int32 radius, int32* outHalfWidths);
@@ -0,0 +1,224 @@
+#include "SRenderQueue.h"
+#include "SProfiler.h"
+#include "SJobSystem.h"
+#include "SRaster.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Texture ids are 16 bits of the sort key, texture 0 is reserved for rectangles
+static constexpr uint32 MaxTextureCount = 0xFFFF;
+
+// Pixels a command can write to as [minX, maxX) x [minY, maxY), rounded the same way Blit and DrawFilledRectangle round
+struct PixelBounds
+{
+	int32 minX;
+	int32 minY;
+	int32 maxX;
+	int32 maxY;
+};
+
+static PixelBounds GetPixelBounds(const RenderCommand& command)
+{
+	const SRect& rect = command.destRect;
+	if (command.image != nullptr)
+	{
+		return PixelBounds { static_cast<int32>(std::round(rect.x)), static_cast<int32>(std::round(rect.y)),
+			static_cast<int32>(std::round(rect.x + rect.width)), static_cast<int32>(std::round(rect.y + rect.height)) };
+	}
+	const int32 x = static_cast<int32>(std::round(rect.x));
+	const int32 y = static_cast<int32>(std::round(rect.y));
+	return PixelBounds { x, y, x + static_cast<int32>(std::round(rect.width)), y + static_cast<int32>(std::round(rect.height)) };
+}
+
+void RenderQueue::DrawImage(uint8 layer, const SImage& image, const SRect& destRect, const SRect& srcRect, BlendMode mode, uint8 flip)
+{
+	if (image.pixels == nullptr)
+	{
+		return;
+	}
+
+	RenderCommand command {};
+	command.sortKey = MakeSortKey(layer, GetTextureId(image), mode);
+	command.mode = mode;
+	command.flip = flip;
+	command.image = &image;
+	command.destRect = destRect;
+	command.srcRect = srcRect;
+	commands.push_back(command);
+}
+
+void RenderQueue::DrawFilledRectangle(uint8 layer, Vector2D position, Vector2D size, Color color)
+{
+	RenderCommand command {};
+	command.sortKey = MakeSortKey(layer, 0, BlendMode::Opaque);
+	command.mode = BlendMode::Opaque;
+	command.color = color;
+	command.destRect = SRect { position.x, position.y, size.x, size.y };
+	commands.push_back(command);
+}
+
+uint32 RenderQueue::GetTextureId(const SImage& image)
+{
+	// Most commands in a row use the same image, and a frame only uses a handful
+	if (lastTextureIndex < textures.size() && textures[lastTextureIndex] == &image)
+	{
+		return static_cast<uint32>(lastTextureIndex + 1);
+	}
+	const auto found = std::find(textures.begin(), textures.end(), &image);
+	lastTextureIndex = static_cast<size_t>(found - textures.begin());
+	if (found == textures.end())
+	{
+		textures.push_back(&image);
+	}
+	return static_cast<uint32>(std::min<size_t>(lastTextureIndex + 1, MaxTextureCount));
+}
+
+uint32 RenderQueue::MakeSortKey(uint8 layer, uint32 textureId, BlendMode mode) const
+{
+	return (static_cast<uint32>(layer) << 24) | (textureId << 8) | (static_cast<uint32>(mode) << 4);
+}
+
+void RenderQueue::Flush()
+{
+	SPROFILE_SCOPE("RenderQueue::Flush");
+
+	const size_t commandCount = commands.size();
+	order.resize(commandCount);
+	orderScratch.resize(commandCount);
+	for (size_t i = 0; i < commandCount; i++)
+	{
+		order[i] = (static_cast<uint64>(commands[i].sortKey) << 32) | i;
+	}
+
+	// Least significant digit first radix sort over the 4 key bytes. Every pass is stable, so equal keys stay in
+	// recording order. A pass where every key has the same byte changes nothing and is skipped.
+	for (int32 shift = 32; shift < 64; shift += 8)
+	{
+		uint32 counts[256] = {};
+		for (uint64 entry : order)
+		{
+			counts[(entry >> shift) & 0xFF]++;
+		}
+		if (commandCount == 0 || counts[(order[0] >> shift) & 0xFF] == commandCount)
+		{
+			continue;
+		}
+
+		uint32 offsets[256];
+		uint32 offset = 0;
+		for (int32 digit = 0; digit < 256; digit++)
+		{
+			offsets[digit] = offset;
+			offset += counts[digit];
+		}
+		for (uint64 entry : order)
+		{
+			orderScratch[offsets[(entry >> shift) & 0xFF]++] = entry;
+		}
+		order.swap(orderScratch);
+	}
+
+	lastBatchCount = 0;
+	uint32 previousBatchKey = 0xFFFFFFFF;
+	for (uint64& entry : order)
+	{
+		// Layer changes don't start a new batch, only texture and blend mode do
+		const uint32 batchKey = static_cast<uint32>(entry >> 32) & 0x00FFFFFF;
+		if (batchKey != previousBatchKey)
+		{
+			previousBatchKey = batchKey;
+			lastBatchCount++;
+		}
+		// Only the command index is needed from here on
+		entry &= 0xFFFFFFFF;
+
+		// The draws below go straight into the framebuffer target, which doesn't track damage on its own
+		const PixelBounds bounds = GetPixelBounds(commands[static_cast<uint32>(entry)]);
+		AddFramebufferDamage(bounds.minX, bounds.minY, bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+	}
+
+	const SRasterTarget target = GetFramebufferTarget();
+	if (jobSystem != nullptr && jobSystem->GetThreadCount() > 1)
+	{
+		DrawTiles(target);
+	}
+	else
+	{
+		for (uint64 entry : order)
+		{
+			DrawCommand(target, commands[static_cast<uint32>(entry)]);
+		}
+	}
+
+	commands.clear();
+	textures.clear();
+	lastTextureIndex = 0;
+}
+
+void RenderQueue::DrawCommand(const SRasterTarget& target, const RenderCommand& command) const
+{
+	if (command.image != nullptr)
+	{
+		::DrawImage(target, *command.image, command.destRect, command.srcRect, command.mode, command.flip);
+	}
+	else
+	{
+		const PixelBounds bounds = GetPixelBounds(command);
+		FillRect(target, bounds.minX, bounds.minY, bounds.maxX - bounds.minX, bounds.maxY - bounds.minY, command.color);
+	}
+}
+
+void RenderQueue::DrawTiles(const SRasterTarget& target)
+{
+	const int32 tileCountX = (target.width + TileSize - 1) / TileSize;
+	const int32 tileCountY = (target.height + TileSize - 1) / TileSize;
+	tileCommands.resize(static_cast<size_t>(tileCountX * tileCountY));
+	for (std::vector<uint32>& tile : tileCommands)
+	{
+		tile.clear();
+	}
+
+	// Binning walks the commands in sorted order, so every tile list comes out sorted too
+	for (uint64 entry : order)
+	{
+		const uint32 index = static_cast<uint32>(entry);
+		const PixelBounds bounds = GetPixelBounds(commands[index]);
+		const int32 minX = std::max(bounds.minX, target.clipMinX);
+		const int32 minY = std::max(bounds.minY, target.clipMinY);
+		const int32 maxX = std::min(bounds.maxX, target.clipMaxX);
+		const int32 maxY = std::min(bounds.maxY, target.clipMaxY);
+		if (minX >= maxX || minY >= maxY)
+		{
+			continue;
+		}
+
+		for (int32 tileY = minY / TileSize; tileY <= (maxY - 1) / TileSize; tileY++)
+		{
+			for (int32 tileX = minX / TileSize; tileX <= (maxX - 1) / TileSize; tileX++)
+			{
+				tileCommands[tileY * tileCountX + tileX].push_back(index);
+			}
+		}
+	}
+
+	// Tiles never overlap, so the workers never write the same pixel
+	jobSystem->ParallelFor(static_cast<uint32>(tileCommands.size()), 1, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 tileIndex = begin; tileIndex < end; tileIndex++)
+		{
+			SPROFILE_SCOPE("RenderQueue::DrawTile");
+			const int32 tileX = static_cast<int32>(tileIndex) % tileCountX * TileSize;
+			const int32 tileY = static_cast<int32>(tileIndex) / tileCountX * TileSize;
+			SRasterTarget tileTarget = target;
+			tileTarget.clipMinX = std::max(target.clipMinX, tileX);
+			tileTarget.clipMinY = std::max(target.clipMinY, tileY);
+			tileTarget.clipMaxX = std::min(target.clipMaxX, tileX + TileSize);
+			tileTarget.clipMaxY = std::min(target.clipMaxY, tileY + TileSize);
+			for (uint32 index : tileCommands[tileIndex])
+			{
+				DrawCommand(tileTarget, commands[index]);
+			}
+		}
+	});
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "SEngine.h"
+
+#include <vector>
+
+class JobSystem;
+
+// Draw commands recorded during a frame and drawn in one go by Flush, ordered by layer, then texture, then blend mode.
+// Commands with the same key keep the order they were recorded in, so what ends up on top doesn't depend on
+// the order entities happen to be stored in, only on their layer.
+// With a job system the framebuffer is split into TileSize tiles, every command is binned into the tiles it touches and
+// the tiles are drawn in parallel. Each tile still gets its commands in sorted order and blits sample per destination
+// pixel, so the result is identical to drawing without one.
+
+struct RenderCommand
+{
+	// Layer << 24 | texture << 8 | blend mode << 4, texture 0 is a filled rectangle
+	uint32 sortKey;
+	BlendMode mode;
+	// BlitFlip bits
+	uint8 flip;
+	Color color;
+	const SImage* image;
+	SRect destRect;
+	SRect srcRect;
+};
+
+class RenderQueue
+{
+public:
+	// The image has to stay alive until the next Flush
+	void DrawImage(uint8 layer, const SImage& image, const SRect& destRect, const SRect& srcRect, BlendMode mode = BlendMode::Alpha, uint8 flip = BlitFlipNone);
+	void DrawFilledRectangle(uint8 layer, Vector2D position, Vector2D size, Color color);
+
+	// Sorts and draws everything recorded since the last Flush, then empties the queue but keeps its memory
+	void Flush();
+
+	// Draws tiles on jobs from the next Flush on, nullptr draws every command on the calling thread
+	void SetJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+
+	static constexpr int32 TileSize = 64;
+
+	size_t GetCommandCount() const { return commands.size(); }
+	// Runs of commands that share texture and blend mode in the last Flush
+	uint32 GetLastBatchCount() const { return lastBatchCount; }
+
+private:
+	uint32 GetTextureId(const SImage& image);
+	uint32 MakeSortKey(uint8 layer, uint32 textureId, BlendMode mode) const;
+	void DrawCommand(const SRasterTarget& target, const RenderCommand& command) const;
+	void DrawTiles(const SRasterTarget& target);
+
+	std::vector<RenderCommand> commands;
+	// Sort key << 32 | command index, and the scratch buffer the radix sort ping pongs with
+	std::vector<uint64> order;
+	std::vector<uint64> orderScratch;
+	// Images in the order they were first drawn this frame, their index + 1 is their texture id
+	std::vector<const SImage*> textures;
+	size_t lastTextureIndex = 0;
+	uint32 lastBatchCount = 0;
+
+	JobSystem* jobSystem = nullptr;
+	// Indices into commands per tile, in sorted order, row major
+	std::vector<std::vector<uint32>> tileCommands;
+};
@@ -0,0 +1,253 @@
+#include "SReplay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+static constexpr char ReplayMagic[4] = { 'S', 'R', 'P', 'L' };
+static constexpr uint32 ReplayVersion = 2;
+
+enum ReplayChanged : uint8
+{
+	ReplayChangedDelta = 1 << 0,
+	ReplayChangedKeys = 1 << 1,
+	ReplayChangedMouse = 1 << 2,
+};
+
+static void AppendLittleEndian(std::vector<uint8>& buffer, uint32 value)
+{
+	buffer.push_back(static_cast<uint8>(value >> 0));
+	buffer.push_back(static_cast<uint8>(value >> 8));
+	buffer.push_back(static_cast<uint8>(value >> 16));
+	buffer.push_back(static_cast<uint8>(value >> 24));
+}
+
+static void AppendLittleEndian16(std::vector<uint8>& buffer, int32 value)
+{
+	buffer.push_back(static_cast<uint8>(value >> 0));
+	buffer.push_back(static_cast<uint8>(value >> 8));
+}
+
+static void AppendKeys(std::vector<uint8>& buffer, const std::vector<char>& keys)
+{
+	const size_t keyCount = std::min<size_t>(keys.size(), 255);
+	buffer.push_back(static_cast<uint8>(keyCount));
+	buffer.insert(buffer.end(), keys.begin(), keys.begin() + keyCount);
+}
+
+ReplayWriter::~ReplayWriter()
+{
+	Close();
+}
+
+bool ReplayWriter::Open(const std::string& path, uint32 seed)
+{
+	Close();
+	file.open(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<uint8> header(std::begin(ReplayMagic), std::end(ReplayMagic));
+	AppendLittleEndian(header, ReplayVersion);
+	AppendLittleEndian(header, seed);
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	bHasPreviousFrame = false;
+	return file.good();
+}
+
+void ReplayWriter::Write(const ReplayFrame& frame)
+{
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	// Most ticks have the same delta and input as the one before, those records are only the flags and the hash
+	uint8 changed = 0;
+	if (!bHasPreviousFrame || frame.deltaTime != previousFrame.deltaTime)
+	{
+		changed |= ReplayChangedDelta;
+	}
+	if (!bHasPreviousFrame || frame.keysDown != previousFrame.keysDown || frame.keysPressed != previousFrame.keysPressed
+		|| frame.keysReleased != previousFrame.keysReleased)
+	{
+		changed |= ReplayChangedKeys;
+	}
+	if (!bHasPreviousFrame || frame.mouseX != previousFrame.mouseX || frame.mouseY != previousFrame.mouseY)
+	{
+		changed |= ReplayChangedMouse;
+	}
+
+	record.clear();
+	record.push_back(changed);
+	if (changed & ReplayChangedDelta)
+	{
+		uint32 deltaBits;
+		std::memcpy(&deltaBits, &frame.deltaTime, sizeof(deltaBits));
+		AppendLittleEndian(record, deltaBits);
+	}
+	if (changed & ReplayChangedKeys)
+	{
+		AppendKeys(record, frame.keysDown);
+		AppendKeys(record, frame.keysPressed);
+		AppendKeys(record, frame.keysReleased);
+	}
+	if (changed & ReplayChangedMouse)
+	{
+		AppendLittleEndian16(record, frame.mouseX);
+		AppendLittleEndian16(record, frame.mouseY);
+	}
+	AppendLittleEndian(record, frame.checksum);
+	file.write(reinterpret_cast<const char*>(record.data()), record.size());
+
+	previousFrame.deltaTime = frame.deltaTime;
+	previousFrame.keysDown.assign(frame.keysDown.begin(), frame.keysDown.end());
+	previousFrame.keysPressed.assign(frame.keysPressed.begin(), frame.keysPressed.end());
+	previousFrame.keysReleased.assign(frame.keysReleased.begin(), frame.keysReleased.end());
+	previousFrame.mouseX = frame.mouseX;
+	previousFrame.mouseY = frame.mouseY;
+	bHasPreviousFrame = true;
+}
+
+void ReplayWriter::Close()
+{
+	if (file.is_open())
+	{
+		file.close();
+	}
+}
+
+// Reads from a loaded file, every read fails once the data runs out
+class ReplayReader
+{
+public:
+	explicit ReplayReader(const std::vector<uint8>& inData)
+		: data(inData)
+	{
+	}
+
+	bool IsAtEnd() const { return offset == data.size(); }
+
+	bool ReadBytes(void* outBytes, size_t count)
+	{
+		if (data.size() - offset < count)
+		{
+			return false;
+		}
+		// Empty key lists read into an empty vector, whose data may be null
+		if (count == 0)
+		{
+			return true;
+		}
+		std::memcpy(outBytes, data.data() + offset, count);
+		offset += count;
+		return true;
+	}
+
+	bool Read8(uint8& outValue)
+	{
+		return ReadBytes(&outValue, 1);
+	}
+
+	bool Read16(int32& outValue)
+	{
+		uint8 bytes[2];
+		if (!ReadBytes(bytes, sizeof(bytes)))
+		{
+			return false;
+		}
+		outValue = static_cast<int16>(bytes[0] | (bytes[1] << 8));
+		return true;
+	}
+
+	bool ReadKeys(std::vector<char>& outKeys)
+	{
+		uint8 keyCount = 0;
+		if (!Read8(keyCount))
+		{
+			return false;
+		}
+		outKeys.resize(keyCount);
+		return ReadBytes(outKeys.data(), keyCount);
+	}
+
+	bool Read32(uint32& outValue)
+	{
+		uint8 bytes[4];
+		if (!ReadBytes(bytes, sizeof(bytes)))
+		{
+			return false;
+		}
+		outValue = static_cast<uint32>(bytes[0]) | (static_cast<uint32>(bytes[1]) << 8) | (static_cast<uint32>(bytes[2]) << 16) | (static_cast<uint32>(bytes[3]) << 24);
+		return true;
+	}
+
+private:
+	const std::vector<uint8>& data;
+	size_t offset = 0;
+};
+
+bool LoadReplay(const std::string& path, ReplayLog& outLog)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	const std::vector<uint8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	ReplayReader reader(data);
+	char magic[4];
+	uint32 version = 0;
+	if (!reader.ReadBytes(magic, sizeof(magic)) || std::memcmp(magic, ReplayMagic, sizeof(magic)) != 0
+		|| !reader.Read32(version) || version != ReplayVersion || !reader.Read32(outLog.seed))
+	{
+		return false;
+	}
+
+	outLog.frames.clear();
+	ReplayFrame frame;
+	while (!reader.IsAtEnd())
+	{
+		uint8 changed = 0;
+		if (!reader.Read8(changed))
+		{
+			return false;
+		}
+		if (changed & ReplayChangedDelta)
+		{
+			uint32 deltaBits = 0;
+			if (!reader.Read32(deltaBits))
+			{
+				return false;
+			}
+			std::memcpy(&frame.deltaTime, &deltaBits, sizeof(deltaBits));
+		}
+		if ((changed & ReplayChangedKeys) && (!reader.ReadKeys(frame.keysDown) || !reader.ReadKeys(frame.keysPressed) || !reader.ReadKeys(frame.keysReleased)))
+		{
+			return false;
+		}
+		if ((changed & ReplayChangedMouse) && (!reader.Read16(frame.mouseX) || !reader.Read16(frame.mouseY)))
+		{
+			return false;
+		}
+		if (!reader.Read32(frame.checksum))
+		{
+			return false;
+		}
+		outLog.frames.push_back(frame);
+	}
+	return true;
+}
+
+uint32 HashPixels(const uint32* pixels, size_t count)
+{
+	uint32 hash = 2166136261u;
+	for (size_t i = 0; i < count; i++)
+	{
+		hash = (hash ^ pixels[i]) * 16777619u;
+	}
+	return hash;
+}
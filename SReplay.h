@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Recording of everything a session fed into Tick: the seed MakeRandomSeed starts from, then per tick the delta, the
+// keys that were down and the mouse position. Replaying it headlessly runs the exact same ticks again.
+// Every tick also stores a hash of the framebuffer it drew, so a replay can tell at which frame it started to differ.
+//
+// File layout, little endian: "SRPL", uint32 version, uint32 seed, then one record per tick.
+// A record starts with a byte of ReplayChanged bits and only holds the parts that changed since the previous tick:
+// float delta, the keys down, pressed and released as uint8 count + keys each, int16 mouse x + y. It ends with the
+// uint32 framebuffer hash.
+
+struct ReplayFrame
+{
+	float deltaTime = 0.f;
+	std::vector<char> keysDown;
+	std::vector<char> keysPressed;
+	std::vector<char> keysReleased;
+	int32 mouseX = -1;
+	int32 mouseY = -1;
+	// HashPixels of the framebuffer after the tick
+	uint32 checksum = 0;
+};
+
+struct ReplayLog
+{
+	uint32 seed = 0;
+	std::vector<ReplayFrame> frames;
+};
+
+class ReplayWriter
+{
+public:
+	~ReplayWriter();
+
+	bool Open(const std::string& path, uint32 seed);
+	void Write(const ReplayFrame& frame);
+	void Close();
+
+	bool IsOpen() const { return file.is_open(); }
+
+private:
+	std::ofstream file;
+	ReplayFrame previousFrame;
+	bool bHasPreviousFrame = false;
+	std::vector<uint8> record;
+};
+
+// Fails on files that aren't replays or are cut off in the middle of a record
+bool LoadReplay(const std::string& path, ReplayLog& outLog);
+
+// FNV-1a over the pixels, cheap enough to run after every recorded tick
+uint32 HashPixels(const uint32* pixels, size_t count);
@@ -0,0 +1,74 @@
+#include "SSpatialHash.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash(float inCellSize, uint32 inBucketCount)
+{
+	cellSize = inCellSize;
+
+	// Round the bucket count up to a power of two so a bucket is a mask instead of a modulo
+	uint32 bucketCount = 1;
+	while (bucketCount < inBucketCount)
+	{
+		bucketCount <<= 1;
+	}
+	bucketMask = bucketCount - 1;
+	bucketStart.assign(bucketCount + 1, 0);
+}
+
+void SpatialHash::Clear()
+{
+	items.clear();
+	cellEntries.clear();
+	std::fill(bucketStart.begin(), bucketStart.end(), 0);
+}
+
+void SpatialHash::Insert(Entity entity, const SRect& rect)
+{
+	const uint32 itemIndex = Cast<uint32>(items.size());
+	items.push_back(Item { entity, rect, queryStamp });
+
+	const int32 startX = ToCell(rect.x);
+	const int32 startY = ToCell(rect.y);
+	const int32 endX = ToCell(rect.x + rect.width);
+	const int32 endY = ToCell(rect.y + rect.height);
+	for (int32 cellY = startY; cellY <= endY; cellY++)
+	{
+		for (int32 cellX = startX; cellX <= endX; cellX++)
+		{
+			cellEntries.push_back(CellEntry { GetBucket(cellX, cellY), itemIndex });
+		}
+	}
+}
+
+void SpatialHash::Build()
+{
+	// Counting sort of the cell entries by bucket
+	std::fill(bucketStart.begin(), bucketStart.end(), 0);
+	for (const CellEntry& entry : cellEntries)
+	{
+		bucketStart[entry.bucket + 1]++;
+	}
+	for (size_t bucket = 1; bucket < bucketStart.size(); bucket++)
+	{
+		bucketStart[bucket] += bucketStart[bucket - 1];
+	}
+
+	bucketItems.resize(cellEntries.size());
+	scratchOffsets.assign(bucketStart.begin(), bucketStart.end() - 1);
+	for (const CellEntry& entry : cellEntries)
+	{
+		bucketItems[scratchOffsets[entry.bucket]++] = entry.itemIndex;
+	}
+}
+
+int32 SpatialHash::ToCell(float position) const
+{
+	return Cast<int32>(std::floor(position / cellSize));
+}
+
+uint32 SpatialHash::GetBucket(int32 cellX, int32 cellY) const
+{
+	return ((Cast<uint32>(cellX) * 73856093u) ^ (Cast<uint32>(cellY) * 19349663u)) & bucketMask;
+}
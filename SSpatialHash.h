@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SECS.h"
+#include "SEngine.h"
+
+#include <vector>
+
+// Uniform grid broadphase. Rects are inserted into every cell they touch, cells are hashed into a fixed amount
+// of buckets so the grid has no bounds. Rebuild it every tick with Clear, Insert and Build, then query it.
+class SpatialHash
+{
+public:
+	explicit SpatialHash(float inCellSize = 16.f, uint32 inBucketCount = 1024);
+
+	// Forgets every inserted rect but keeps the memory for the next tick
+	void Clear();
+	void Insert(Entity entity, const SRect& rect);
+	// Sorts everything inserted since Clear into its buckets, has to be called before querying
+	void Build();
+
+	size_t Size() const { return items.size(); }
+
+	// Calls func once for every inserted entity whose rect overlaps rect (same test as SRect::IsRectangleOverlapping)
+	template<typename Func>
+	void Query(const SRect& rect, Func&& func)
+	{
+		queryStamp++;
+
+		const int32 startX = ToCell(rect.x);
+		const int32 startY = ToCell(rect.y);
+		const int32 endX = ToCell(rect.x + rect.width);
+		const int32 endY = ToCell(rect.y + rect.height);
+		for (int32 cellY = startY; cellY <= endY; cellY++)
+		{
+			for (int32 cellX = startX; cellX <= endX; cellX++)
+			{
+				const uint32 bucket = GetBucket(cellX, cellY);
+				for (uint32 i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++)
+				{
+					// Rects spanning several cells, or cells sharing a bucket, would otherwise be reported twice
+					Item& item = items[bucketItems[i]];
+					if (item.queryStamp == queryStamp)
+					{
+						continue;
+					}
+					item.queryStamp = queryStamp;
+
+					if (item.rect.IsRectangleOverlapping(rect))
+					{
+						func(item.entity);
+					}
+				}
+			}
+		}
+	}
+
+private:
+	struct Item
+	{
+		Entity entity;
+		SRect rect;
+		uint32 queryStamp;
+	};
+
+	struct CellEntry
+	{
+		uint32 bucket;
+		uint32 itemIndex;
+	};
+
+	int32 ToCell(float position) const;
+	uint32 GetBucket(int32 cellX, int32 cellY) const;
+
+	float cellSize;
+	uint32 bucketMask;
+	uint32 queryStamp = 0;
+
+	std::vector<Item> items;
+	// One entry for every cell an item touches, filled by Insert and sorted into bucketItems by Build
+	std::vector<CellEntry> cellEntries;
+	std::vector<uint32> bucketStart;
+	std::vector<uint32> bucketItems;
+	std::vector<uint32> scratchOffsets;
+};
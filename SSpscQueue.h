@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SWait.h"
+#include "Typedefs.h"
+
+#include <atomic>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Push never blocks or allocates, the consumer can block in WaitForData while the queue is empty.
+template<typename T, uint32 Capacity>
+class SpscQueue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+public:
+	// Producer only, wait-free. Returns false and drops the value when the queue is full.
+	bool Push(const T& value)
+	{
+		const uint32 currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - head.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+
+		items[currentTail & (Capacity - 1)] = value;
+		tail.store(currentTail + 1, std::memory_order_seq_cst);
+
+		// Only pay for the wake when the consumer is actually asleep
+		if (consumerWaiting.load(std::memory_order_seq_cst) != 0)
+		{
+			WakeOneWaiter(tail);
+		}
+		return true;
+	}
+
+	// Consumer only. Returns false when the queue is empty.
+	bool Pop(T& outValue)
+	{
+		const uint32 currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		outValue = items[currentHead & (Capacity - 1)];
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. Blocks until at least one value can be popped.
+	void WaitForData()
+	{
+		while (true)
+		{
+			const uint32 observedTail = tail.load(std::memory_order_seq_cst);
+			if (observedTail != head.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			// Announce the sleep before checking again, a push in between changes tail and the wait returns at once
+			consumerWaiting.store(1, std::memory_order_seq_cst);
+			if (tail.load(std::memory_order_seq_cst) == observedTail)
+			{
+				WaitOnValue(tail, observedTail);
+			}
+			consumerWaiting.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	bool IsEmpty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+private:
+	// Producer and consumer positions live on separate cache lines so they don't bounce between cores
+	alignas(64) std::atomic<uint32> head { 0 };
+	alignas(64) std::atomic<uint32> tail { 0 };
+	alignas(64) std::atomic<uint32> consumerWaiting { 0 };
+	T items[Capacity];
+};
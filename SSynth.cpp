@@ -0,0 +1,180 @@
+#include "SSynth.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Same velocity the midi output used (0x70), scaled down so a full square wave doesn't clip
+static constexpr int16 NoteAmplitude = static_cast<int16>(32767 * 0.3 * 0x70 / 127);
+
+PulseSynth::PulseSynth()
+{
+	for (uint32 noteId = 0; noteId < 128; noteId++)
+	{
+		const double frequency = 440.0 * std::pow(2.0, (static_cast<double>(noteId) - 69.0) / 12.0);
+		phaseSteps[noteId] = static_cast<uint32>(frequency / SampleRate * 4294967296.0);
+	}
+}
+
+bool PulseSynth::QueueNote(const MusicNote& note)
+{
+	return noteQueue.Push(note);
+}
+
+void PulseSynth::ReadSamples(int16* outSamples, uint32 sampleCount)
+{
+	while (sampleCount > 0)
+	{
+		if (blockReadPosition == BlockSize)
+		{
+			RenderBlock(block, BlockSize);
+			blockReadPosition = 0;
+		}
+
+		const uint32 count = std::min(sampleCount, BlockSize - blockReadPosition);
+		std::copy(block + blockReadPosition, block + blockReadPosition + count, outSamples);
+		blockReadPosition += count;
+		outSamples += count;
+		sampleCount -= count;
+	}
+}
+
+bool PulseSynth::IsIdle() const
+{
+	return !bPlaying && blockReadPosition == BlockSize && noteQueue.IsEmpty();
+}
+
+void PulseSynth::WaitForNotes()
+{
+	noteQueue.WaitForData();
+}
+
+bool PulseSynth::StartNextNote()
+{
+	MusicNote note;
+	while (noteQueue.Pop(note))
+	{
+		if (!bPlaying)
+		{
+			// First note after silence starts right here
+			scheduleStartSample = renderedSamples;
+			scheduledMs = 0;
+		}
+		bPlaying = true;
+
+		scheduledMs += std::max<int64>(note.duration.count(), 0);
+		noteEndSample = scheduleStartSample + static_cast<uint64>(scheduledMs) * SampleRate / 1000;
+		if (noteEndSample > renderedSamples)
+		{
+			amplitude = note.noteId != 0 ? NoteAmplitude : 0;
+			phaseStep = phaseSteps[note.noteId & 0x7F];
+			return true;
+		}
+	}
+
+	bPlaying = false;
+	amplitude = 0;
+	return false;
+}
+
+void PulseSynth::RenderBlock(int16* outSamples, uint32 sampleCount)
+{
+	while (sampleCount > 0)
+	{
+		if ((!bPlaying || renderedSamples >= noteEndSample) && !StartNextNote())
+		{
+			std::fill(outSamples, outSamples + sampleCount, int16(0));
+			renderedSamples += sampleCount;
+			return;
+		}
+
+		// Everything up to the end of the current note or the block, whichever comes first
+		const uint32 count = static_cast<uint32>(std::min<uint64>(sampleCount, noteEndSample - renderedSamples));
+		if (amplitude == 0)
+		{
+			std::fill(outSamples, outSamples + count, int16(0));
+		}
+		else
+		{
+			// 50% duty cycle, the top bit of the phase is the square wave
+			for (uint32 i = 0; i < count; i++)
+			{
+				outSamples[i] = (phase & 0x80000000u) ? static_cast<int16>(-amplitude) : amplitude;
+				phase += phaseStep;
+			}
+		}
+
+		outSamples += count;
+		sampleCount -= count;
+		renderedSamples += count;
+	}
+}
+
+WavFileSink::~WavFileSink()
+{
+	Close();
+}
+
+static void WriteLittleEndian(std::ofstream& file, uint32 value, int32 byteCount)
+{
+	for (int32 i = 0; i < byteCount; i++)
+	{
+		file.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+	}
+}
+
+bool WavFileSink::Open(const std::string& path, uint32 sampleRate)
+{
+	Close();
+	file.open(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	constexpr uint32 Channels = 1;
+	constexpr uint32 BitsPerSample = 16;
+	dataBytes = 0;
+
+	file.write("RIFF", 4);
+	WriteLittleEndian(file, 36, 4); // patched in Close
+	file.write("WAVE", 4);
+	file.write("fmt ", 4);
+	WriteLittleEndian(file, 16, 4);
+	WriteLittleEndian(file, 1, 2); // PCM
+	WriteLittleEndian(file, Channels, 2);
+	WriteLittleEndian(file, sampleRate, 4);
+	WriteLittleEndian(file, sampleRate * Channels * BitsPerSample / 8, 4);
+	WriteLittleEndian(file, Channels * BitsPerSample / 8, 2);
+	WriteLittleEndian(file, BitsPerSample, 2);
+	file.write("data", 4);
+	WriteLittleEndian(file, 0, 4); // patched in Close
+	return true;
+}
+
+void WavFileSink::Write(const int16* samples, uint32 sampleCount)
+{
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	for (uint32 i = 0; i < sampleCount; i++)
+	{
+		WriteLittleEndian(file, static_cast<uint16>(samples[i]), 2);
+	}
+	dataBytes += sampleCount * 2;
+}
+
+void WavFileSink::Close()
+{
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	file.seekp(4);
+	WriteLittleEndian(file, 36 + dataBytes, 4);
+	file.seekp(40);
+	WriteLittleEndian(file, dataBytes, 4);
+	file.close();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "SSpscQueue.h"
+#include "Typedefs.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+// Portable software synthesizer that replaces the windows midi output.
+// Plays one note at a time with a pulse wave, notes are scheduled back to back on exact sample positions.
+// Output is signed 16 bit mono PCM.
+
+// noteId is a midi note number, 0 is a rest that only takes up time
+struct MusicNote { uint8 noteId; std::chrono::milliseconds duration; };
+
+class PulseSynth
+{
+public:
+	static constexpr uint32 SampleRate = 44100;
+	// Samples rendered in one go, ReadSamples hands them out in whatever amount the audio device asks for
+	static constexpr uint32 BlockSize = 256;
+
+	PulseSynth();
+
+	// Any thread, but only one. Returns false and drops the note when the queue is full.
+	bool QueueNote(const MusicNote& note);
+
+	// Audio thread only
+	void ReadSamples(int16* outSamples, uint32 sampleCount);
+	// True when no note is playing and none are queued, the output is silence until the next QueueNote
+	bool IsIdle() const;
+	// Blocks the audio thread until a note gets queued
+	void WaitForNotes();
+
+private:
+	void RenderBlock(int16* outSamples, uint32 sampleCount);
+	bool StartNextNote();
+
+	SpscQueue<MusicNote, 256> noteQueue;
+
+	// Phase step per sample for every midi note, phase wraps at 2^32
+	uint32 phaseSteps[128];
+	uint32 phase = 0;
+	uint32 phaseStep = 0;
+	int16 amplitude = 0;
+
+	// Notes that follow each other are timed from the first one, so rounding never drifts the melody
+	uint64 renderedSamples = 0;
+	uint64 scheduleStartSample = 0;
+	int64 scheduledMs = 0;
+	uint64 noteEndSample = 0;
+	bool bPlaying = false;
+
+	int16 block[BlockSize];
+	uint32 blockReadPosition = BlockSize;
+};
+
+// Streams PCM into a .wav file, the header sizes are patched when the sink gets closed
+class WavFileSink
+{
+public:
+	~WavFileSink();
+
+	bool Open(const std::string& path, uint32 sampleRate);
+	void Write(const int16* samples, uint32 sampleCount);
+	void Close();
+
+	bool IsOpen() const { return file.is_open(); }
+
+private:
+	std::ofstream file;
+	uint32 dataBytes = 0;
+};
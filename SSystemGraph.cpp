@@ -0,0 +1,87 @@
+#include "SSystemGraph.h"
+#include "SJobSystem.h"
+#include "SProfiler.h"
+
+#include <algorithm>
+
+static bool Contains(const std::vector<const void*>& resources, const void* resource)
+{
+	return std::find(resources.begin(), resources.end(), resource) != resources.end();
+}
+
+bool SystemGraph::Conflicts(const SystemAccess& lhs, const SystemAccess& rhs)
+{
+	for (const void* resource : lhs.writes)
+	{
+		if (Contains(rhs.reads, resource) || Contains(rhs.writes, resource))
+		{
+			return true;
+		}
+	}
+	for (const void* resource : rhs.writes)
+	{
+		if (Contains(lhs.reads, resource))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void SystemGraph::Add(const char* name, SystemAccess access, std::function<void(float)> update)
+{
+	const uint32 index = static_cast<uint32>(systems.size());
+	System system { name, std::move(access), std::move(update), {}, {} };
+	for (uint32 earlier = 0; earlier < index; earlier++)
+	{
+		if (Conflicts(systems[earlier].access, system.access))
+		{
+			system.dependencies.push_back(earlier);
+			systems[earlier].dependents.push_back(index);
+		}
+	}
+	systems.push_back(std::move(system));
+	waitingCounts = std::make_unique<std::atomic<uint32>[]>(systems.size());
+}
+
+void SystemGraph::Clear()
+{
+	systems.clear();
+	waitingCounts.reset();
+}
+
+void SystemGraph::Run(JobSystem& jobs, float deltaTime)
+{
+	SPROFILE_SCOPE("SystemGraph::Run");
+	for (size_t i = 0; i < systems.size(); i++)
+	{
+		waitingCounts[i] = static_cast<uint32>(systems[i].dependencies.size());
+	}
+
+	// A finished system submits the dependents it was the last dependency of. It does so before its own job counts as
+	// done, so the counter can't reach zero while systems are still left to run.
+	JobCounter counter;
+	std::function<void(uint32)> submit = [&](uint32 index)
+	{
+		jobs.Submit([&, index]()
+		{
+			systems[index].update(deltaTime);
+			for (uint32 dependent : systems[index].dependents)
+			{
+				if (--waitingCounts[dependent] == 0)
+				{
+					submit(dependent);
+				}
+			}
+		}, counter);
+	};
+
+	for (uint32 i = 0; i < systems.size(); i++)
+	{
+		if (systems[i].dependencies.empty())
+		{
+			submit(i);
+		}
+	}
+	jobs.Wait(counter);
+}
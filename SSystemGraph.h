@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class JobSystem;
+
+// Game systems that declare what they read and write, run as a dependency graph on a JobSystem.
+// Systems are added in the order they would run one after the other. A system waits for every earlier system it
+// conflicts with, meaning one of the two writes something the other reads or writes, all others run at the same time.
+// Resources are plain addresses, usually of a ComponentStore, but anything shared can be declared, e.g. a render queue.
+//
+// graph.Add("Bullets", { { &attributesArray }, { &transformArray } }, [](float deltaTime) { ... });
+// graph.Run(jobs, deltaTime);
+
+struct SystemAccess
+{
+	std::vector<const void*> reads;
+	std::vector<const void*> writes;
+};
+
+class SystemGraph
+{
+public:
+	void Add(const char* name, SystemAccess access, std::function<void(float)> update);
+	void Clear();
+
+	// Runs every system once and returns when all of them finished
+	void Run(JobSystem& jobs, float deltaTime);
+
+	size_t GetSystemCount() const { return systems.size(); }
+	const char* GetSystemName(uint32 systemIndex) const { return systems[systemIndex].name; }
+	// Systems an earlier system has to finish before systemIndex can start
+	const std::vector<uint32>& GetDependencies(uint32 systemIndex) const { return systems[systemIndex].dependencies; }
+
+private:
+	struct System
+	{
+		const char* name;
+		SystemAccess access;
+		std::function<void(float)> update;
+		std::vector<uint32> dependencies;
+		std::vector<uint32> dependents;
+	};
+
+	static bool Conflicts(const SystemAccess& lhs, const SystemAccess& rhs);
+
+	std::vector<System> systems;
+	// Dependencies a system still waits on during Run
+	std::unique_ptr<std::atomic<uint32>[]> waitingCounts;
+};
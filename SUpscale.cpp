@@ -0,0 +1,115 @@
+#include "SUpscale.h"
+#include "SJobSystem.h"
+#include "SRaster.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SUPSCALE_SSE2 1
+#endif
+
+// Writes every pixel of source scale times next to each other
+static void ExpandRow(const uint32* source, int32 count, int32 scale, uint32* dest)
+{
+	int32 i = 0;
+#if SUPSCALE_SSE2
+	// 4 source pixels per iteration, pshufd picks which of them lands in which output lane
+	if (scale == 2)
+	{
+		for (; i + 4 <= count; i += 4, dest += 8)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi32(pixels, pixels));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), _mm_unpackhi_epi32(pixels, pixels));
+		}
+	}
+	else if (scale == 3)
+	{
+		for (; i + 4 <= count; i += 4, dest += 12)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 0, 0, 0)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 1, 1)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 8), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 2)));
+		}
+	}
+	else if (scale == 4)
+	{
+		for (; i + 4 <= count; i += 4, dest += 16)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 0, 0, 0)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 1, 1, 1)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 8), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 2, 2)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 12), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3)));
+		}
+	}
+#endif
+
+	if (scale > 4)
+	{
+		for (; i < count; i++, dest += scale)
+		{
+			FillSpan(dest, scale, source[i]);
+		}
+		return;
+	}
+	for (; i < count; i++)
+	{
+		for (int32 copy = 0; copy < scale; copy++)
+		{
+			*dest++ = source[i];
+		}
+	}
+}
+
+static void UpscaleRows(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region, int32 minY, int32 maxY)
+{
+	const int32 count = region.GetWidth();
+	const size_t destWidth = static_cast<size_t>(count) * scale;
+	for (int32 y = minY; y < maxY; y++)
+	{
+		uint32* firstRow = dest.pixels + static_cast<size_t>(y) * scale * dest.pitch + static_cast<size_t>(region.minX) * scale;
+		ExpandRow(source + static_cast<size_t>(y) * sourcePitch + region.minX, count, scale, firstRow);
+		for (int32 copy = 1; copy < scale; copy++)
+		{
+			std::copy(firstRow, firstRow + destWidth, firstRow + static_cast<size_t>(copy) * dest.pitch);
+		}
+	}
+}
+
+void UpscaleNearest(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region)
+{
+	if (region.IsEmpty() || scale <= 0)
+	{
+		return;
+	}
+	UpscaleRows(source, sourcePitch, dest, scale, region, region.minY, region.maxY);
+}
+
+void UpscaleNearest(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region, JobSystem& jobs)
+{
+	if (region.IsEmpty() || scale <= 0)
+	{
+		return;
+	}
+
+	// Every job writes whole output rows, so no two jobs touch the same cache line unless the rows are tiny
+	const uint32 minRowsPerJob = static_cast<uint32>(std::max(1, 16384 / std::max(1, region.GetWidth() * scale * scale)));
+	jobs.ParallelFor(static_cast<uint32>(region.GetHeight()), minRowsPerJob, [&](uint32 begin, uint32 end)
+	{
+		UpscaleRows(source, sourcePitch, dest, scale, region, region.minY + static_cast<int32>(begin), region.minY + static_cast<int32>(end));
+	});
+}
+
+void UpscaleNearestReference(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region)
+{
+	for (int32 y = region.minY * scale; y < region.maxY * scale; y++)
+	{
+		for (int32 x = region.minX * scale; x < region.maxX * scale; x++)
+		{
+			dest.pixels[static_cast<size_t>(y) * dest.pitch + x] = source[static_cast<size_t>(y / scale) * sourcePitch + x / scale];
+		}
+	}
+}
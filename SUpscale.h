@@ -0,0 +1,25 @@
+#pragma once
+
+#include "SDamage.h"
+#include "Typedefs.h"
+
+class JobSystem;
+
+// Integer nearest neighbour upscaling of 0xAARRGGBB pixels, for presenting the framebuffer at PixelScale.
+// Every output row is expanded from its source row once, the other scale - 1 rows of that pixel row are copies of it.
+// Uses SSE2 shuffles for scale 2, 3 and 4, wider scales write runs of one color. UpscaleNearestReference is the
+// plain version they have to match.
+
+struct UpscaleImage
+{
+	uint32* pixels;
+	// Distance between two rows in pixels
+	int32 pitch;
+};
+
+// Scales region of source into dest, which has to be scale times the size of source. Pixels outside
+// region * scale are left untouched.
+void UpscaleNearest(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region);
+// Same, with the source rows split over jobs
+void UpscaleNearest(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region, JobSystem& jobs);
+void UpscaleNearestReference(const uint32* source, int32 sourcePitch, const UpscaleImage& dest, int32 scale, const DamageRect& region);
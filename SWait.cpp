@@ -0,0 +1,82 @@
+#include "SWait.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#endif
+
+static_assert(sizeof(std::atomic<uint32>) == sizeof(uint32), "Waiting on an atomic needs it to be a plain 32 bit value");
+
+#if !defined(_WIN32) && !defined(__linux__)
+// Without an address wait in the OS, waiters sleep on a condition variable picked by the address. Addresses share
+// buckets, so wakes notify everyone in the bucket and the others go back to sleep after re-checking.
+struct WaitBucket
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+};
+
+static WaitBucket& GetWaitBucket(const std::atomic<uint32>& value)
+{
+	static WaitBucket buckets[64];
+	const uintptr_t address = reinterpret_cast<uintptr_t>(&value);
+	return buckets[(address >> 4) % 64];
+}
+
+static void WakeWaiters(std::atomic<uint32>& value)
+{
+	WaitBucket& bucket = GetWaitBucket(value);
+	// Taking the lock orders the wake after a waiter that checked the value but isn't asleep yet
+	{
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+	}
+	bucket.condition.notify_all();
+}
+#endif
+
+void WaitOnValue(std::atomic<uint32>& value, uint32 expected)
+{
+#if defined(_WIN32)
+	WaitOnAddress(&value, &expected, sizeof(uint32), INFINITE);
+#elif defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32*>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+	WaitBucket& bucket = GetWaitBucket(value);
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	if (value.load() == expected)
+	{
+		bucket.condition.wait(lock);
+	}
+#endif
+}
+
+void WakeOneWaiter(std::atomic<uint32>& value)
+{
+#if defined(_WIN32)
+	WakeByAddressSingle(&value);
+#elif defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32*>(&value), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+	WakeWaiters(value);
+#endif
+}
+
+void WakeAllWaiters(std::atomic<uint32>& value)
+{
+#if defined(_WIN32)
+	WakeByAddressAll(&value);
+#elif defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32*>(&value), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+	WakeWaiters(value);
+#endif
+}
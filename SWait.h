@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Typedefs.h"
+
+#include <atomic>
+
+// Blocks the calling thread while value still holds expected. Can return spuriously, callers re-check their condition.
+// Uses futex on linux and WaitOnAddress on windows, other platforms wait on a condition variable picked by the address.
+void WaitOnValue(std::atomic<uint32>& value, uint32 expected);
+// Wakes one thread blocked in WaitOnValue on the same atomic
+void WakeOneWaiter(std::atomic<uint32>& value);
+// Wakes every thread blocked in WaitOnValue on the same atomic
+void WakeAllWaiters(std::atomic<uint32>& value);
@@ -0,0 +1,98 @@
+#include "SAssetPack.h"
+#include "SPng.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Offline cooker that decodes every png below a directory into one asset pack, see SAssetPack.h.
+// Sprite sheets are listed in an optional cells.txt in that directory, one "<image path> <cellCountX> <cellCountY>" per line.
+// Build: g++ -O2 -std=c++17 -pthread assetcooker.cpp SAssetPack.cpp SPng.cpp -o assetcooker.out
+// Run:   ./assetcooker.out Assets Assets.pack
+
+struct CellCount { int32 x; int32 y; };
+
+static std::unordered_map<std::string, CellCount> ReadCellCounts(const std::filesystem::path& path)
+{
+	std::unordered_map<std::string, CellCount> cellCounts;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		std::string name;
+		CellCount cellCount { 1, 1 };
+		if (stream >> name >> cellCount.x >> cellCount.y && name[0] != '#')
+		{
+			cellCounts[name] = cellCount;
+		}
+	}
+	return cellCounts;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		std::cout << "Usage: " << argv[0] << " <asset directory> <output pack>" << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path sourceDirectory = argv[1];
+	const std::string outputPath = argv[2];
+	if (!std::filesystem::is_directory(sourceDirectory))
+	{
+		std::cout << sourceDirectory.string() << " is not a directory" << std::endl;
+		return 1;
+	}
+
+	const std::unordered_map<std::string, CellCount> cellCounts = ReadCellCounts(sourceDirectory / "cells.txt");
+
+	// Stored under the path the games pass to SLoadImage, which is relative to the working directory
+	std::vector<std::string> paths;
+	for (const std::filesystem::directory_entry& file : std::filesystem::recursive_directory_iterator(sourceDirectory))
+	{
+		if (file.is_regular_file() && file.path().extension() == ".png")
+		{
+			paths.push_back(file.path().generic_string());
+		}
+	}
+
+	std::vector<DecodedPng> decodedImages;
+	const std::vector<PngError> errors = LoadPngs(paths, decodedImages);
+
+	std::vector<CookedImage> images;
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		if (errors[i] != PngError::None)
+		{
+			std::cout << "Failed to decode " << paths[i] << ": " << GetPngErrorName(errors[i]) << std::endl;
+			return 1;
+		}
+
+		CookedImage image;
+		image.name = paths[i];
+		image.width = decodedImages[i].width;
+		image.height = decodedImages[i].height;
+		image.pixels = std::move(decodedImages[i].pixels);
+		const auto cellCount = cellCounts.find(image.name);
+		if (cellCount != cellCounts.end())
+		{
+			image.cellCountX = cellCount->second.x;
+			image.cellCountY = cellCount->second.y;
+		}
+		std::cout << image.name << " " << image.width << "x" << image.height << std::endl;
+		images.push_back(std::move(image));
+	}
+
+	if (!WriteAssetPack(outputPath, std::move(images)))
+	{
+		std::cout << "Failed to write " << outputPath << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,352 @@
+#include "SBenchmark.h"
+#include "SEngine.h"
+#include "SPlatform.h"
+#include "SRenderQueue.h"
+#include "SJobSystem.h"
+#include "SUpscale.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Micro-benchmarks for every SEngine.h drawing primitive, drawing into the engine framebuffer without a window.
+// Build: g++ -O2 -std=c++17 -pthread benchmark.cpp SBlit.cpp SDamage.cpp SEngine.cpp SHeadless.cpp SInput.cpp SPng.cpp SRaster.cpp SFrameScheduler.cpp SProfiler.cpp SJobSystem.cpp SRenderQueue.cpp SReplay.cpp SSynth.cpp SUpscale.cpp SWait.cpp -o benchmark.out
+// Run:   ./benchmark.out --out benchmark.json [--min-time 0.05]
+
+// The engine core calls into the game, the benchmark has none
+void Start() {}
+void Tick(float deltaTime) {}
+
+static constexpr Color BenchmarkColor = 0xFFFFFFFF;
+
+// Every case draws its shape at this many positions per call so clipping and cache effects average out
+static constexpr int32 PositionCount = 64;
+
+struct BenchmarkPosition { int32 x; int32 y; };
+
+static std::vector<BenchmarkPosition> MakePositions()
+{
+	// Deterministic spread over the framebuffer, shapes near the edges get clipped like they would in a game
+	std::vector<BenchmarkPosition> positions;
+	uint32 seed = 12345;
+	for (int32 i = 0; i < PositionCount; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		const int32 x = static_cast<int32>((seed >> 8) % Width);
+		seed = seed * 1664525u + 1013904223u;
+		const int32 y = static_cast<int32>((seed >> 8) % Height);
+		positions.push_back(BenchmarkPosition { x, y });
+	}
+	return positions;
+}
+
+// Average pixels one draw writes, every position is drawn on its own so overlapping shapes are all counted
+template<typename Func>
+static uint64 CountPixels(const std::vector<BenchmarkPosition>& positions, Func&& draw)
+{
+	uint64 pixels = 0;
+	const Color* framebuffer = GetFramebuffer();
+	for (const BenchmarkPosition& position : positions)
+	{
+		Clear(0);
+		draw(position);
+		for (int32 i = 0; i < Width * Height; i++)
+		{
+			pixels += framebuffer[i] != 0 ? 1 : 0;
+		}
+	}
+	return pixels / positions.size();
+}
+
+// Times draw at every position, one operation is one draw
+template<typename Func>
+static void RunCase(BenchmarkRunner& runner, const std::string& name, const std::string& parameters, const std::vector<BenchmarkPosition>& positions, Func&& draw)
+{
+	const uint64 pixelsPerOperation = CountPixels(positions, draw);
+	runner.Run(name, parameters, pixelsPerOperation, positions.size(), [&]
+	{
+		for (const BenchmarkPosition& position : positions)
+		{
+			draw(position);
+		}
+	});
+}
+
+static SImage MakeImage(int32 width, int32 height)
+{
+	SImage image {};
+	image.assetPath = "benchmark";
+	image.width = width;
+	image.height = height;
+	image.pixels = new Color[width * height];
+	for (int32 i = 0; i < width * height; i++)
+	{
+		image.pixels[i] = 0xFF00AA00;
+	}
+	return image;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkRunner runner;
+	const std::string outputPath = ParseBenchmarkArguments(argc, argv, runner);
+	const std::vector<BenchmarkPosition> positions = MakePositions();
+
+	RunCase(runner, "Clear", "", { positions[0] }, [](const BenchmarkPosition&) { Clear(BenchmarkColor); });
+
+	RunCase(runner, "SetPixel", "", positions, [&](const BenchmarkPosition& position)
+	{
+		SetPixel(position.x, position.y, BenchmarkColor);
+	});
+
+	for (int32 length : { 8, 32, 128, 319 })
+	{
+		const std::string parameters = "length=" + std::to_string(length);
+		RunCase(runner, "DrawLine horizontal", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawLine(position.x, position.y, position.x + length, position.y, BenchmarkColor);
+		});
+		RunCase(runner, "DrawLine vertical", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawLine(position.x, position.y, position.x, position.y + length, BenchmarkColor);
+		});
+		RunCase(runner, "DrawLine diagonal", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawLine(position.x, position.y, position.x + length, position.y + length / 2, BenchmarkColor);
+		});
+	}
+
+	// A plotted curve across the screen, one short segment per column like Graphing.cpp draws
+	{
+		std::vector<RasterPoint> plot(Width);
+		for (int32 x = 0; x < Width; x++)
+		{
+			plot[x] = RasterPoint { x, Height / 2 + static_cast<int32>(std::sin(x / 10.f) * 100.f) };
+		}
+		RunCase(runner, "DrawPolyline", "points=" + std::to_string(Width), { positions[0] }, [&](const BenchmarkPosition&)
+		{
+			DrawPolyline(plot, BenchmarkColor);
+		});
+		RunCase(runner, "DrawLine per segment", "points=" + std::to_string(Width), { positions[0] }, [&](const BenchmarkPosition&)
+		{
+			for (int32 x = 1; x < Width; x++)
+			{
+				DrawLine(plot[x - 1].x, plot[x - 1].y, plot[x].x, plot[x].y, BenchmarkColor);
+			}
+		});
+	}
+
+	for (int32 size : { 1, 4, 16, 64, 240 })
+	{
+		const std::string parameters = "size=" + std::to_string(size);
+		RunCase(runner, "DrawRectangle", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawRectangle(position.x - size / 2, position.y - size / 2, size, size, BenchmarkColor);
+		});
+		RunCase(runner, "DrawFilledRectangle", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawFilledRectangle(position.x - size / 2, position.y - size / 2, size, size, BenchmarkColor);
+		});
+	}
+
+	for (int32 radius : { 2, 8, 32, 120 })
+	{
+		const std::string parameters = "radius=" + std::to_string(radius);
+		RunCase(runner, "DrawFilledCircle", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawFilledCircle(position.x, position.y, radius, BenchmarkColor);
+		});
+		RunCase(runner, "DrawFilledEllipse", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawFilledEllipse(position.x, position.y, radius, radius / 2, BenchmarkColor);
+		});
+	}
+
+	for (int32 size : { 8, 32, 128 })
+	{
+		const std::string parameters = "size=" + std::to_string(size);
+		const SImage image = MakeImage(size, size);
+		const SRect srcRect { 0.f, 0.f, static_cast<float>(size), static_cast<float>(size) };
+
+		RunCase(runner, "DrawImage position", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawImage(image, Vector2D { static_cast<float>(position.x), static_cast<float>(position.y) });
+		});
+		RunCase(runner, "DrawImage scaled 2x", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawImage(image, position.x, position.y, size * 2, size * 2);
+		});
+		RunCase(runner, "DrawImage rect", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			const SRect destRect { static_cast<float>(position.x), static_cast<float>(position.y), static_cast<float>(size), static_cast<float>(size) };
+			DrawImage(image, destRect, srcRect);
+		});
+
+		// Sprite sheet of 4 cells, each cell is size x size
+		SSprite sprite {};
+		sprite.srcImage = MakeImage(size * 4, size);
+		sprite.cellSizeX = static_cast<float>(size);
+		sprite.index = 2;
+		RunCase(runner, "DrawSprite", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawSprite(sprite, Vector2D { static_cast<float>(position.x), static_cast<float>(position.y) });
+		});
+		RunCase(runner, "DrawSprite scaled 2x", parameters, positions, [&](const BenchmarkPosition& position)
+		{
+			DrawSprite(sprite, Vector2D { static_cast<float>(position.x), static_cast<float>(position.y) }, Vector2D { 2.f, 2.f });
+		});
+
+		delete[] sprite.srcImage.pixels;
+		delete[] image.pixels;
+	}
+
+	// Every blend mode through the fast kernels and the scalar reference, with a mix of alpha values like anti aliased sprites have
+	const std::pair<BlendMode, const char*> blendModes[] = {
+		{ BlendMode::Opaque, "opaque" }, { BlendMode::ColorKey, "colorkey" }, { BlendMode::Alpha, "alpha" },
+		{ BlendMode::PremultipliedAlpha, "premultiplied" }, { BlendMode::Additive, "additive" }, { BlendMode::Multiply, "multiply" } };
+	std::vector<uint32> spanSource(Width);
+	std::vector<uint32> spanDest(Width, 0xFF204060);
+	for (int32 i = 0; i < Width; i++)
+	{
+		spanSource[i] = (static_cast<uint32>(i * 37 % 256) << 24) | 0x00AA5500;
+	}
+	for (const auto& [mode, modeName] : blendModes)
+	{
+		const std::string parameters = std::string("mode=") + modeName + " length=" + std::to_string(Width);
+		// Spans don't go into the framebuffer, so they can't be counted by CountPixels
+		runner.Run("BlendSpan", parameters, Width, 1, [&]
+		{
+			BlendSpan(mode, spanDest.data(), spanSource.data(), Width, 0);
+		});
+		runner.Run("BlendSpanReference", parameters, Width, 1, [&]
+		{
+			BlendSpanReference(mode, spanDest.data(), spanSource.data(), Width, 0);
+		});
+
+		const SImage image = MakeImage(64, 64);
+		std::copy(spanSource.begin(), spanSource.begin() + 64, image.pixels);
+		const SRect srcRect { 0.f, 0.f, 64.f, 64.f };
+		RunCase(runner, "DrawImage blend", std::string("mode=") + modeName + " size=64", positions, [&](const BenchmarkPosition& position)
+		{
+			const SRect destRect { static_cast<float>(position.x), static_cast<float>(position.y), 64.f, 64.f };
+			DrawImage(image, destRect, srcRect, mode);
+		});
+		RunCase(runner, "DrawImage blend flipped", std::string("mode=") + modeName + " size=64", positions, [&](const BenchmarkPosition& position)
+		{
+			const SRect destRect { static_cast<float>(position.x), static_cast<float>(position.y), 64.f, 64.f };
+			DrawImage(image, destRect, srcRect, mode, BlitFlipX | BlitFlipY);
+		});
+		delete[] image.pixels;
+	}
+
+	// A frame worth of alpha blended sprites through the tiled RenderQueue, the 1 thread run is the reference the others
+	// have to match pixel for pixel
+	{
+		const int32 spriteCount = 2048;
+		const SImage image = MakeImage(32, 32);
+		std::copy(spanSource.begin(), spanSource.begin() + 32, image.pixels);
+		const SRect srcRect { 0.f, 0.f, 32.f, 32.f };
+		auto record = [&](RenderQueue& queue)
+		{
+			for (int32 i = 0; i < spriteCount; i++)
+			{
+				const BenchmarkPosition& position = positions[i % positions.size()];
+				const SRect destRect { static_cast<float>(position.x + i % 7 - 16), static_cast<float>(position.y + i % 5 - 16), 32.f, 32.f };
+				queue.DrawImage(static_cast<uint8>(i % 3), image, destRect, srcRect);
+			}
+		};
+		const uint64 pixelsPerSprite = CountPixels(positions, [&](const BenchmarkPosition& position)
+		{
+			DrawImage(image, SRect { static_cast<float>(position.x - 16), static_cast<float>(position.y - 16), 32.f, 32.f }, srcRect);
+		});
+
+		std::vector<Color> reference;
+		for (uint32 threadCount : { 1u, 2u, 4u, 8u })
+		{
+			JobSystem jobs(threadCount);
+			RenderQueue queue;
+			queue.SetJobSystem(&jobs);
+
+			Clear(0);
+			record(queue);
+			queue.Flush();
+			const std::vector<Color> result(GetFramebuffer(), GetFramebuffer() + Width * Height);
+			if (reference.empty())
+			{
+				reference = result;
+			}
+			else if (result != reference)
+			{
+				std::cout << "RenderQueue with " << threadCount << " threads differs from the single threaded result" << std::endl;
+				return 1;
+			}
+
+			runner.Run("RenderQueue sprites", "threads=" + std::to_string(threadCount) + " count=" + std::to_string(spriteCount), pixelsPerSprite * spriteCount, 1, [&]
+			{
+				record(queue);
+				queue.Flush();
+			});
+		}
+		delete[] image.pixels;
+	}
+
+	// Presenting the whole framebuffer at window size, the reference is what the fast and threaded versions have to match
+	{
+		Clear(0);
+		for (int32 i = 0; i < Width * Height; i++)
+		{
+			SetPixel(i % Width, i / Width, 0xFF000000 | static_cast<uint32>(i * 2654435761u >> 8));
+		}
+		const DamageRect frame { 0, 0, Width, Height };
+		JobSystem jobs;
+		for (int32 scale : { 2, 3, 4, 5 })
+		{
+			const int32 scaledWidth = Width * scale;
+			std::vector<uint32> reference(static_cast<size_t>(scaledWidth) * Height * scale);
+			std::vector<uint32> result(reference.size());
+			UpscaleNearestReference(GetFramebuffer(), Width, UpscaleImage { reference.data(), scaledWidth }, scale, frame);
+			UpscaleNearest(GetFramebuffer(), Width, UpscaleImage { result.data(), scaledWidth }, scale, frame);
+			const bool bFastMatches = result == reference;
+			std::fill(result.begin(), result.end(), 0);
+			UpscaleNearest(GetFramebuffer(), Width, UpscaleImage { result.data(), scaledWidth }, scale, frame, jobs);
+			if (!bFastMatches || result != reference)
+			{
+				std::cout << "UpscaleNearest at scale " << scale << " differs from the reference" << std::endl;
+				return 1;
+			}
+
+			const std::string parameters = "scale=" + std::to_string(scale);
+			runner.Run("UpscaleNearest", parameters, reference.size(), 1, [&]
+			{
+				UpscaleNearest(GetFramebuffer(), Width, UpscaleImage { result.data(), scaledWidth }, scale, frame);
+			});
+			runner.Run("UpscaleNearest threaded", parameters + " threads=" + std::to_string(jobs.GetThreadCount()), reference.size(), 1, [&]
+			{
+				UpscaleNearest(GetFramebuffer(), Width, UpscaleImage { result.data(), scaledWidth }, scale, frame, jobs);
+			});
+			runner.Run("UpscaleNearestReference", parameters, reference.size(), 1, [&]
+			{
+				UpscaleNearestReference(GetFramebuffer(), Width, UpscaleImage { reference.data(), scaledWidth }, scale, frame);
+			});
+		}
+	}
+
+	const std::string text = "SCORE 0123456789";
+	for (int32 size = 1; size <= 8; size++)
+	{
+		RunCase(runner, "DrawString", "size=" + std::to_string(size), positions, [&](const BenchmarkPosition& position)
+		{
+			DrawString(position.x, position.y, text, Left, BenchmarkColor, size);
+		});
+	}
+
+	if (!outputPath.empty() && !runner.WriteJson(outputPath))
+	{
+		std::cout << "Failed to write " << outputPath << std::endl;
+		return 1;
+	}
+	return 0;
+}
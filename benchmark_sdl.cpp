@@ -0,0 +1,127 @@
+#include "SBenchmark.h"
+#include "SDL_Renderer.h"
+#include "SHeadless.h"
+#include "SRaster.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Micro-benchmarks for the circle paths of SDL_Renderer.cpp, drawing into the offscreen software renderer of StartHeadless.
+// Every operation includes its share of FlushDrawBatches, that is where SDL actually rasterizes.
+// Build: g++ -O2 -std=c++17 benchmark_sdl.cpp SDL_Renderer.cpp SHeadless.cpp SRaster.cpp -o benchmark_sdl.out -lSDL2
+// Run:   ./benchmark_sdl.out --out benchmark_sdl.json [--min-time 0.05]
+
+// Points DrawCircle submits, the same midpoint walk pushes 8 points per step
+static uint64 CountCirclePoints(int radius)
+{
+	uint64 points = 0;
+	int offsetX = 0;
+	int offsetY = radius;
+	int d = radius - 1;
+	while (offsetY >= offsetX)
+	{
+		points += 8;
+		if (d >= 2 * offsetX)
+		{
+			d -= 2 * offsetX + 1;
+			offsetX += 1;
+		}
+		else if (d < 2 * (radius - offsetY))
+		{
+			d += 2 * offsetY - 1;
+			offsetY -= 1;
+		}
+		else
+		{
+			d += 2 * (offsetY - offsetX - 1);
+			offsetY -= 1;
+			offsetX += 1;
+		}
+	}
+	return points;
+}
+
+static uint64 CountFilledCirclePixels(int radius)
+{
+	std::vector<int32> halfWidths(radius + 1);
+	ComputeCircleHalfWidths(radius, halfWidths.data());
+
+	uint64 pixels = 0;
+	for (int row = 0; row <= radius; row++)
+	{
+		if (halfWidths[row] >= 0)
+		{
+			pixels += (row == 0 ? 1 : 2) * static_cast<uint64>(2 * halfWidths[row] + 1);
+		}
+	}
+	return pixels;
+}
+
+class CircleBenchmark : public GameEngine
+{
+public:
+	BenchmarkRunner runner;
+
+	// StartHeadless has created the renderer by now, all cases run from here
+	void Initialize() override
+	{
+		for (int radius : { 2, 8, 32, 128 })
+		{
+			for (int count : { 1, 16, 256 })
+			{
+				const std::string parameters = "radius=" + std::to_string(radius) + " count=" + std::to_string(count);
+				runner.Run("DrawCircle", parameters, CountCirclePoints(radius), count, [&]
+				{
+					DrawCircles(radius, count, false);
+				});
+				runner.Run("DrawCircleFilled", parameters, CountFilledCirclePixels(radius), count, [&]
+				{
+					DrawCircles(radius, count, true);
+				});
+			}
+		}
+	}
+
+private:
+	void DrawCircles(int radius, int count, bool bFilled)
+	{
+		// Alternate colors so the color batching has some work to do
+		for (int i = 0; i < count; i++)
+		{
+			const int x = 300 + (i * 37) % 200 - 100;
+			const int y = 300 + (i * 53) % 200 - 100;
+			const Color color = (i & 1) != 0 ? Yellow : LightCyan;
+			if (bFilled)
+			{
+				DrawCircleFilled(x, y, radius, color);
+			}
+			else
+			{
+				DrawCircle(x, y, radius, color);
+			}
+		}
+		FlushDrawBatches();
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	CircleBenchmark benchmark;
+	const std::string outputPath = ParseBenchmarkArguments(argc, argv, benchmark.runner);
+
+	HeadlessSettings settings;
+	settings.frameCount = 0;
+	const int exitCode = benchmark.StartHeadless(settings);
+	if (exitCode != 0)
+	{
+		return exitCode;
+	}
+
+	if (!outputPath.empty() && !benchmark.runner.WriteJson(outputPath))
+	{
+		std::cout << "Failed to write " << outputPath << std::endl;
+		return 1;
+	}
+	return 0;
+}
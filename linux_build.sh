@@ -0,0 +1,3 @@
+#! /bin/bash
+echo building project
+g++ SEngine.cpp SEngine_SDL.cpp SAssets.cpp SAssetPack.cpp SBlit.cpp SDamage.cpp SHeadless.cpp SInput.cpp SJobSystem.cpp SPng.cpp SRaster.cpp SSpatialHash.cpp SSystemGraph.cpp SFrameScheduler.cpp SProfiler.cpp SRenderQueue.cpp SReplay.cpp SSynth.cpp SUpscale.cpp SWait.cpp SMath.cpp $1.cpp -o $1.out -lSDL2 -std=c++17 -pthread
@@ -1,3 +1,3 @@
 #! /bin/bash
 Echo building project
-g++ SDL_Renderer.cpp $1.cpp -o $1.out -lsdl2 -std=c++17
\ No newline at end of file
+g++ SDL_Renderer.cpp SHeadless.cpp SProfiler.cpp SRaster.cpp $1.cpp -o $1.out -lsdl2 -std=c++17
\ No newline at end of file
@@ -1,10 +1,17 @@
 #include <algorithm>
 
+#include "SAssetPack.h"
+#include "SAssets.h"
+#include "SECS.h"
 #include "SEngine.h"
 #include "SMath.h"
+#include "SProfiler.h"
+#include "SRenderQueue.h"
+#include "SJobSystem.h"
+#include "SSpatialHash.h"
+#include "SSystemGraph.h"
 
 #include <iostream>
-#include <map>
 #include <vector>
 
 static constexpr float INVADER_SPEED = 5.f;
@@ -12,16 +19,18 @@ static constexpr float  INVADER_X_OFFSET = 15.f;
 static constexpr float  INVADER_Y_OFFSET = 10.f;
 static constexpr float INVADER_MOVE_STEP_TIME = 0.5f;
 static constexpr float INVADER_SHOOT_CHANCE = 0.1f;
+// Loops over fewer entities than this don't get split over threads
+static constexpr uint32 ENTITY_CHUNK_SIZE = 256;
+// Bullet pools get this much room up front, they only grow past it when more bullets are in flight
+static constexpr size_t BULLET_POOL_SIZE = 1024;
 
 #define ARROW_LEFT 0x25
 #define ARROW_RIGHT 0x27
 #define SPACEBAR 0x20
 #define RETURN 0x0D
 
-static int32 idCounter = 0;
-static int32 NewId() { return idCounter++; }
-static int32 assetIdCounter = 0;
-static int32 NewAssetId() { return assetIdCounter++; }
+static EntityRegistry entityRegistry;
+static Entity NewId() { return entityRegistry.Create(); }
 
 struct Attributes
 {
@@ -29,6 +38,18 @@ struct Attributes
 	int32 HEALTH;
 };
 
+// Bullets don't share any components with other entities, so they live in pools that hold all of a bullet in one struct
+struct Bullet
+{
+	Transform transform;
+	float speed;
+
+	SRect GetCollisionRect() const
+	{
+		return SRect { transform.Position.x, transform.Position.y, transform.Scale.x, transform.Scale.y };
+	}
+};
+
 enum class Direction
 {
 	Left,
@@ -38,74 +59,75 @@ enum class Direction
 };
 
 
-std::map<int32, Transform> transformArray;
-std::map<int32, Attributes> attributesArray;
+ComponentStore<Transform> transformArray;
+ComponentStore<Attributes> attributesArray;
 
-std::map<int32, class Renderable_Image> renderableImagesArray;
-std::map<int32, class Renderable_Sprite> renderableSpriteArray;
-std::map<int32, class Renderable_Square> renderableSquareArray;
-std::map<int32, class CollisionBox> collisionBoxArray;
+ComponentStore<class Renderable_Image> renderableImagesArray;
+ComponentStore<class Renderable_Sprite> renderableSpriteArray;
+ComponentStore<class Renderable_Square> renderableSquareArray;
+ComponentStore<class CollisionBox> collisionBoxArray;
 
-std::map<int32, class PlayerControl> playerControlArray;
-std::map<int32, bool> bulletArray;
-std::map<int32, bool> playerBulletArray;
-std::map<int32, bool> enemyBulletArray;
+ComponentStore<class PlayerControl> playerControlArray;
+ObjectPool<Bullet> playerBulletPool;
+ObjectPool<Bullet> enemyBulletPool;
 
-std::map<int32, bool> invaderArray;
-std::map<int32, bool> obstacleArray;
+ComponentStore<Tag> invaderArray;
+ComponentStore<Tag> obstacleArray;
 
-std::map<int32, SImage> imageAssetArray;
+// Broadphase for bullet collisions, rebuilt every tick by the BroadphaseManager
+SpatialHash invaderGrid;
+SpatialHash obstacleGrid;
 
-int32 playerEntityId;
-int32 playerScore = 0;
-bool isInMenu = true;
+// Cooked by assetcooker.out, the registry falls back to decoding the pngs when it is missing
+AssetPack assetPack;
+AssetRegistry assets;
+// Held for the whole game so spawning only has to bump a reference count
+AssetHandle invaderAsset;
+AssetHandle obstacleAsset;
 
-int32 GetAssetId(const std::string& assetPath)
+// Everything the render managers draw goes through here, the layers decide what ends up on top
+RenderQueue renderQueue;
+// Runs the game systems, the loops they split into chunks and the tiles of renderQueue
+JobSystem jobs;
+SystemGraph gameSystems;
+enum RenderLayer : uint8
 {
-	for (auto image : imageAssetArray)
-	{
-		if (image.second.assetPath == assetPath)
-		{
-			return image.first;
-		}
-	}
+	PlayerLayer,
+	SpriteLayer,
+	SquareLayer,
+};
 
-	const int32 newAssetId = NewAssetId();
-	SImage newImage;
-	SLoadImage(assetPath, newImage);
-	imageAssetArray[newAssetId] = newImage;
-	return newAssetId;
-}
+Entity playerEntityId;
+int32 playerScore = 0;
+bool isInMenu = true;
 
 class Renderable_Image
 {
 public:
-	int32 entityId;
-	int32 assetId;
+	AssetHandle asset;
 
 	Renderable_Image() = default;
-	Renderable_Image(int32 inEntityId, int32 inAssetId) 
+	Renderable_Image(AssetHandle inAsset) 
 	{
-		entityId = inEntityId;
-		assetId = inAssetId;
+		asset = inAsset;
 	}
 
-	void Render()
+	void Render(const Transform& transform)
 	{
-		const Transform transform = transformArray[entityId];
 		const Vector2D position = transform.Position; 
-		const SImage image = imageAssetArray[assetId];
-		const int32 width = image.GetHalfWidth();
-		const int32 height = image.GetHalfHeight();
-		DrawImage(image, Vector2D{position.x - width, position.y - height});	
+		const SImage& image = assets.GetImage(asset);
+		const int32 x = Cast<int32>(position.x - image.GetHalfWidth());
+		const int32 y = Cast<int32>(position.y - image.GetHalfHeight());
+		const SRect destRect { Cast<float>(x), Cast<float>(y), Cast<float>(image.width), Cast<float>(image.height) };
+		const SRect srcRect { 0.f, 0.f, Cast<float>(image.width), Cast<float>(image.height) };
+		renderQueue.DrawImage(PlayerLayer, image, destRect, srcRect);
 	}
 };
 
 class Renderable_Sprite
 {
 public:
-	int32 entityId;
-	int32 assetId;
+	AssetHandle asset;
 	
 	Vector2D SpriteCellSize;
 
@@ -113,27 +135,25 @@ public:
 	bool update = true;
 
 	Renderable_Sprite() = default;
-	Renderable_Sprite(int32 inEntityId, int32 inAssetId, int32 inCellCountX, int32 inCellCountY = 1) 
+	Renderable_Sprite(AssetHandle inAsset, int32 inCellCountX, int32 inCellCountY = 1) 
 	{
-		entityId = inEntityId;
-		assetId = inAssetId;
+		asset = inAsset;
 		cellCountX = inCellCountX;
 		cellCountY = inCellCountY;
 
-		const SImage& image = imageAssetArray[assetId];
+		const SImage& image = assets.GetImage(asset);
 		SpriteCellSize.x = image.width / cellCountX;
 		SpriteCellSize.y = image.height / cellCountY;
 	}
 
-	void Render(float deltaTime)
+	void Render(const Transform& transform, float deltaTime)
 	{
-		const Transform transform = transformArray[entityId];
 		const Vector2D position = transform.Position; 
-		const SImage image = imageAssetArray[assetId];
+		const SImage& image = assets.GetImage(asset);
 
 		SRect srcRect = SRect {position.x, position.y, SpriteCellSize.x * transform.Scale.x, SpriteCellSize.y  * transform.Scale.y};
 		SRect dstRect = SRect {SpriteCellSize.x * index, 0, SpriteCellSize.x, SpriteCellSize.y };
-		DrawSprite(image, srcRect, dstRect);
+		renderQueue.DrawImage(SpriteLayer, image, srcRect, dstRect);
 		
 		UpdateSprite(deltaTime);
 	}
@@ -170,48 +190,43 @@ private:
 class Renderable_Square
 {
 public:
-	int32 entityId;
 	Color color;
 
 	Renderable_Square() = default;
 
-	void Render()
+	void Render(const Transform& transform)
 	{
-		const Transform& transform = transformArray[entityId];
-		DrawFilledRectangle(transform.Position, transform.Scale, color);	
+		renderQueue.DrawFilledRectangle(SquareLayer, transform.Position, transform.Scale, color);
 	}
 };
 
 class CollisionBox
 {
 public:
-	int32 EntityId;
 	Vector2D Scale;
 	Vector2D Offset;
 
-	SRect GetRect() const
+	SRect GetRect(const Transform& transform) const
 	{
-		const Transform& transform = transformArray[EntityId];
 		return SRect { transform.Position.x + Offset.x, transform.Position.y + Offset.y, Scale.x, Scale.y };	
 	}
-
-	bool IsColliding(int32 inEntityId) const
-	{
-		const CollisionBox& collisionBox = collisionBoxArray[EntityId];
-		const CollisionBox& otherCollisionBox = collisionBoxArray[inEntityId];
-		return collisionBox.GetRect().IsRectangleOverlapping(otherCollisionBox.GetRect());
-	}
 };
 
+SRect GetCollisionRect(Entity entityId)
+{
+	return collisionBoxArray.Get(entityId).GetRect(transformArray.Get(entityId));
+}
+
 class ImageRenderManager
 {
 public:
 	void Update(float deltaTime)
 	{
-		for (auto renderPair: renderableImagesArray)
+		SPROFILE_SCOPE("ImageRenderManager::Update");
+		View<Renderable_Image, Transform>(renderableImagesArray, transformArray).ForEach([](Entity, Renderable_Image& image, const Transform& transform)
 		{
-			renderPair.second.Render();
-		}
+			image.Render(transform);
+		});
 	}
 };
 
@@ -220,10 +235,11 @@ class SpriteRenderManager
 public:
 	void Update(float deltaTime)
 	{
-		for (std::pair<const int32, Renderable_Sprite>& renderPair : renderableSpriteArray)
+		SPROFILE_SCOPE("SpriteRenderManager::Update");
+		View<Renderable_Sprite, Transform>(renderableSpriteArray, transformArray).ForEach([deltaTime](Entity, Renderable_Sprite& sprite, const Transform& transform)
 		{
-			renderPair.second.Render(deltaTime);
-		}
+			sprite.Render(transform, deltaTime);
+		});
 	}
 };
 
@@ -232,9 +248,18 @@ class SquareRenderManager
 public:
 	void Update(float deltaTime)
 	{
-		for (auto renderPair : renderableSquareArray)
+		SPROFILE_SCOPE("SquareRenderManager::Update");
+		View<Renderable_Square, Transform>(renderableSquareArray, transformArray).ForEach([](Entity, Renderable_Square& square, const Transform& transform)
 		{
-			renderPair.second.Render();
+			square.Render(transform);
+		});
+
+		for (const ObjectPool<Bullet>* pool : { &playerBulletPool, &enemyBulletPool })
+		{
+			for (const Bullet& bullet : pool->GetObjects())
+			{
+				renderQueue.DrawFilledRectangle(SquareLayer, bullet.transform.Position, bullet.transform.Scale, White);
+			}
 		}
 	}
 };
@@ -244,39 +269,30 @@ class CollisionRenderManager
 public:
 	void Update(float deltaTime)
 	{
-		for (std::pair<const int32, CollisionBox>& colliders : collisionBoxArray)
+		SPROFILE_SCOPE("CollisionRenderManager::Update");
+		View<CollisionBox, Transform>(collisionBoxArray, transformArray).ForEach([](Entity, const CollisionBox& collider, const Transform& transform)
+		{
+			DrawRectangle(Vector2D {transform.Position.x + collider.Offset.x, transform.Position.y + collider.Offset.y }, collider.Scale, Green);
+		});
+
+		for (const ObjectPool<Bullet>* pool : { &playerBulletPool, &enemyBulletPool })
 		{
-			const Transform& transform = transformArray[colliders.first];
-			DrawRectangle(Vector2D {transform.Position.x + colliders.second.Offset.x, transform.Position.y + colliders.second.Offset.y }, colliders.second.Scale, Green);
-		}	
+			for (const Bullet& bullet : pool->GetObjects())
+			{
+				DrawRectangle(bullet.transform.Position, bullet.transform.Scale, Green);
+			}
+		}
 	}
 };
 
-int32 CreateBullet(const Transform& inTransform, float speed)
-{
-	const int32 entityId = NewId();
-	transformArray[entityId] = Transform{ inTransform.Position, Vector2D {2.0f, 5.0f}};
-	attributesArray[entityId] = Attributes{speed};
-	renderableSquareArray[entityId] = Renderable_Square {entityId, White };
-	collisionBoxArray[entityId] = CollisionBox { entityId, transformArray[entityId].Scale };
-	bulletArray[entityId] = true;
-	return entityId;
-}
-
-void DeleteBullet(int32 entityId)
+Entity CreateBullet(ObjectPool<Bullet>& pool, const Transform& inTransform, float speed)
 {
-	transformArray.erase(entityId);
-	attributesArray.erase(entityId);
-	renderableSquareArray.erase(entityId);
-	collisionBoxArray.erase(entityId);
-	bulletArray.erase(entityId);
-	playerBulletArray.erase(entityId);
-	enemyBulletArray.erase(entityId);
+	return pool.Spawn(Bullet { Transform { inTransform.Position, Vector2D { 2.0f, 5.0f } }, speed });
 }
 
 void RemovePlayerHealth()
 {
-	Attributes& attribute = attributesArray[playerEntityId];
+	Attributes& attribute = attributesArray.Get(playerEntityId);
 	attribute.HEALTH = std::clamp(attribute.HEALTH - 1, 0, attribute.HEALTH);
 
 	if (attribute.HEALTH <= 0)
@@ -285,28 +301,29 @@ void RemovePlayerHealth()
 	}
 }
 
-void DeleteSpaceInvader(int32 entityId);
+void DeleteSpaceInvader(Entity entityId);
 
 class PlayerControl
 {
 public:
-	int32 entityId;
+	Entity entityId;
 	
 	void Update(float deltaTime)
 	{
-		Transform& transform = transformArray[entityId];
+		SPROFILE_SCOPE("PlayerControl::Update");
+		Transform& transform = transformArray.Get(entityId);
+		const Attributes& attributes = attributesArray.Get(entityId);
 		if (IsKeyDown(ARROW_LEFT))
 		{
-			transform.Position.x -= attributesArray[entityId].SPEED * deltaTime;
+			transform.Position.x -= attributes.SPEED * deltaTime;
 		}
 		if (IsKeyDown(ARROW_RIGHT))
 		{
-			transform.Position.x += attributesArray[entityId].SPEED * deltaTime;		
+			transform.Position.x += attributes.SPEED * deltaTime;		
 		}
-		if (IsKeyDown(SPACEBAR) && playerBulletArray.size() <= 0)
+		if (IsKeyDown(SPACEBAR) && playerBulletPool.IsEmpty())
 		{
-			int32 entityId = CreateBullet(transform, -100.f);
-			playerBulletArray[entityId] = true;
+			CreateBullet(playerBulletPool, transform, -100.f);
 		}
 	}
 };
@@ -316,9 +333,10 @@ class ControllerManager
 public:
 	void Update(float deltaTime)
 	{
-		for (auto controllerPair : playerControlArray)
+		SPROFILE_SCOPE("ControllerManager::Update");
+		for (PlayerControl& controller : playerControlArray.GetComponents())
 		{
-			controllerPair.second.Update(deltaTime);
+			controller.Update(deltaTime);
 		}
 	}
 };
@@ -328,30 +346,76 @@ class BulletManager
 public:
 	void Update(float deltaTime)
 	{
-		std::vector<int32> bulletsToDelete;
-		for (auto entityId : bulletArray)
-		{
-			Transform& transform = transformArray[entityId.first];
-			Attributes& attribute = attributesArray[entityId.first];
-			Vector2D& position = transform.Position;
-			position.y += attribute.SPEED * deltaTime;
+		SPROFILE_SCOPE("BulletManager::Update");
+		Update(playerBulletPool, deltaTime);
+		Update(enemyBulletPool, deltaTime);
+	}
 
-			if (position.y <= 0.f)
+private:
+	void Update(ObjectPool<Bullet>& pool, float deltaTime)
+	{
+		// Every bullet only writes itself, so the move can be split over threads
+		std::vector<Bullet>& bullets = pool.GetObjects();
+		jobs.ParallelFor(Cast<uint32>(bullets.size()), ENTITY_CHUNK_SIZE, [&](uint32 begin, uint32 end)
+		{
+			for (uint32 i = begin; i < end; i++)
 			{
-				bulletsToDelete.push_back(entityId.first);
-				continue;
+				bullets[i].transform.Position.y += bullets[i].speed * deltaTime;
 			}
-			if (position.y >= Height)
+		});
+
+		bulletsToDelete.clear();
+		for (size_t i = 0; i < bullets.size(); i++)
+		{
+			const Vector2D& position = bullets[i].transform.Position;
+			if (position.y <= 0.f || position.y >= Height)
 			{
-				bulletsToDelete.push_back(entityId.first);
-				continue;
+				bulletsToDelete.push_back(pool.GetHandles()[i]);
 			}
 		}
 
-		for (auto bulletEntityId : bulletsToDelete)
+		for (const Entity bulletEntityId : bulletsToDelete)
+		{
+			pool.Despawn(bulletEntityId);
+		}
+	}
+
+	// Kept between ticks so despawning doesn't allocate
+	std::vector<Entity> bulletsToDelete;
+};
+
+class BroadphaseManager
+{
+public:
+	void Update(float deltaTime)
+	{
+		SPROFILE_SCOPE("BroadphaseManager::Update");
+		UpdateInvaders(deltaTime);
+		UpdateObstacles(deltaTime);
+	}
+
+	// The grids don't share any data, so the game systems rebuild them at the same time
+	void UpdateInvaders(float deltaTime)
+	{
+		SPROFILE_SCOPE("BroadphaseManager::UpdateInvaders");
+		Rebuild(invaderGrid, invaderArray);
+	}
+
+	void UpdateObstacles(float deltaTime)
+	{
+		SPROFILE_SCOPE("BroadphaseManager::UpdateObstacles");
+		Rebuild(obstacleGrid, obstacleArray);
+	}
+
+private:
+	void Rebuild(SpatialHash& grid, const ComponentStore<Tag>& entities)
+	{
+		grid.Clear();
+		for (const Entity entityId : entities.GetEntities())
 		{
-			DeleteBullet(bulletEntityId);	
+			grid.Insert(entityId, GetCollisionRect(entityId));
 		}
+		grid.Build();
 	}
 };
 
@@ -360,53 +424,51 @@ class PlayerBulletManager
 public:
 	void Update(float deltaTime)
 	{
-		std::vector<int32> bulletsToDelete;
-		int32 invaderToDelete = -1;
+		SPROFILE_SCOPE("PlayerBulletManager::Update");
+		bulletsToDelete.clear();
+		Entity invaderToDelete;
 		
-		for (auto bulletEntityId : playerBulletArray)
+		const std::vector<Bullet>& bullets = playerBulletPool.GetObjects();
+		for (size_t i = 0; i < bullets.size(); i++)
 		{
-			const CollisionBox& bulletCollider = collisionBoxArray[bulletEntityId.first]; 
-			for (const auto invaderEntityId : invaderArray)
+			invaderGrid.Query(bullets[i].GetCollisionRect(), [&](Entity invaderEntityId)
 			{
-				if (bulletCollider.IsColliding(invaderEntityId.first))
-				{
-					bulletsToDelete.push_back(bulletEntityId.first);
-					invaderToDelete = invaderEntityId.first;
-				}
-			}
+				bulletsToDelete.push_back(playerBulletPool.GetHandles()[i]);
+				invaderToDelete = invaderEntityId;
+			});
 		}
 
-		for (auto bulletEntityId : playerBulletArray)
+		for (size_t i = 0; i < bullets.size(); i++)
 		{
-			const CollisionBox& bulletCollider = collisionBoxArray[bulletEntityId.first];
-			for (auto obstacleEntityId : obstacleArray)
+			obstacleGrid.Query(bullets[i].GetCollisionRect(), [&](Entity obstacleEntityId)
 			{
-				Attributes& attribute = attributesArray[obstacleEntityId.first];
+				Attributes& attribute = attributesArray.Get(obstacleEntityId);
 				if(attribute.HEALTH <= 0)
 				{
-					continue;
+					return;
 				}
-				if (bulletCollider.IsColliding(obstacleEntityId.first))
-				{
-					attribute.HEALTH--;
-					renderableSpriteArray[obstacleEntityId.first].IncrementCellCountX();
 
-					bulletsToDelete.push_back(bulletEntityId.first);
-				}
-			}
+				attribute.HEALTH--;
+				renderableSpriteArray.Get(obstacleEntityId).IncrementCellCountX();
+
+				bulletsToDelete.push_back(playerBulletPool.GetHandles()[i]);
+			});
 		}
 
-		for (const int32& bullets_to_delete : bulletsToDelete)
+		for (const Entity& bullets_to_delete : bulletsToDelete)
 		{
-			DeleteBullet(bullets_to_delete);
+			playerBulletPool.Despawn(bullets_to_delete);
 		}
 		
-		if (invaderToDelete != -1)
+		if (invaderToDelete.IsValid())
 		{
 			DeleteSpaceInvader(invaderToDelete);
 			playerScore += 25;
 		}
 	}
+
+private:
+	std::vector<Entity> bulletsToDelete;
 };
 
 
@@ -415,43 +477,45 @@ class InvaderBulletManager
 public:
 	void Update(float deltaTime)
 	{
-		std::vector<int32> bulletToDelete;
+		SPROFILE_SCOPE("InvaderBulletManager::Update");
+		bulletToDelete.clear();
 
-		for (auto bulletEntityId : enemyBulletArray)
+		const std::vector<Bullet>& bullets = enemyBulletPool.GetObjects();
+		for (size_t i = 0; i < bullets.size(); i++)
 		{
-			const CollisionBox& bulletCollider = collisionBoxArray[bulletEntityId.first];
-			for (auto obstacleEntityId : obstacleArray)
+			obstacleGrid.Query(bullets[i].GetCollisionRect(), [&](Entity obstacleEntityId)
 			{
-				Attributes& attribute = attributesArray[obstacleEntityId.first];
+				Attributes& attribute = attributesArray.Get(obstacleEntityId);
 				if(attribute.HEALTH <= 0)
 				{
-					continue;
-				}
-				if (bulletCollider.IsColliding(obstacleEntityId.first))
-				{
-					attribute.HEALTH--;
-					renderableSpriteArray[obstacleEntityId.first].IncrementCellCountX();
-					
-					bulletToDelete.push_back(bulletEntityId.first);		
+					return;
 				}
-			}
+
+				attribute.HEALTH--;
+				renderableSpriteArray.Get(obstacleEntityId).IncrementCellCountX();
+				
+				bulletToDelete.push_back(enemyBulletPool.GetHandles()[i]);		
+			});
 		}
 
-		for (auto bulletEntityId : enemyBulletArray)
+		const SRect playerRect = GetCollisionRect(playerEntityId);
+		for (size_t i = 0; i < bullets.size(); i++)
 		{
-			const CollisionBox& playerCollider = collisionBoxArray[playerEntityId];
-			if (playerCollider.IsColliding(bulletEntityId.first))
+			if (playerRect.IsRectangleOverlapping(bullets[i].GetCollisionRect()))
 			{
 				RemovePlayerHealth();
-				bulletToDelete.push_back(bulletEntityId.first);
+				bulletToDelete.push_back(enemyBulletPool.GetHandles()[i]);
 			}
 		}
 
-		for (int32 bulletEntityId : bulletToDelete)
+		for (Entity bulletEntityId : bulletToDelete)
 		{
-			DeleteBullet(bulletEntityId);
+			enemyBulletPool.Despawn(bulletEntityId);
 		}
 	}
+
+private:
+	std::vector<Entity> bulletToDelete;
 };
 
 class InvaderManager
@@ -462,26 +526,21 @@ public:
 	
 	void Update(float deltaTime)
 	{
+		SPROFILE_SCOPE("InvaderManager::Update");
 		UpdateMovement();
 		
 		timer += deltaTime;
 		
 		const float normalizedRandom = (Cast<float>(std::rand()) / Cast<float>(RAND_MAX)) * 100.f;
-		int32 invaderIndexToShoot = (std::rand() / (RAND_MAX / (invaderArray.size() - 1)));
-		invaderIndexToShoot = normalizedRandom < INVADER_SHOOT_CHANCE ? invaderIndexToShoot : -1;
+		const int32 invaderCount = Cast<int32>(invaderArray.Size());
+		const int32 random = std::rand();
+		int32 invaderIndexToShoot = invaderCount > 1 ? std::min(random / (RAND_MAX / (invaderCount - 1)), invaderCount - 1) : 0;
+		invaderIndexToShoot = normalizedRandom < INVADER_SHOOT_CHANCE && invaderCount > 0 ? invaderIndexToShoot : -1;
 
 		if (invaderIndexToShoot != -1)
 		{
-			std::vector<int> keys;
-			for (auto invader : invaderArray)
-			{
-				keys.push_back(invader.first);	
-			}
-
-			const int32 invaderEntityId = keys[invaderIndexToShoot];
-			const Transform& transform = transformArray[invaderEntityId];
-			const int32 bulletEntityId = CreateBullet(transform, 100.f);
-			enemyBulletArray[bulletEntityId] = true;	
+			const Entity invaderEntityId = invaderArray.GetEntities()[invaderIndexToShoot];
+			CreateBullet(enemyBulletPool, transformArray.Get(invaderEntityId), 100.f);
 		}
 	}
 
@@ -490,26 +549,22 @@ public:
 		while(timer >= INVADER_MOVE_STEP_TIME)
 		{
 			// Update space invader positions
-			for (auto entityId : invaderArray)
+			const std::vector<Entity>& invaders = invaderArray.GetEntities();
+			const float step = movementDirection == Direction::Left ? -INVADER_SPEED : movementDirection == Direction::Right ? INVADER_SPEED : 0.f;
+			jobs.ParallelFor(Cast<uint32>(invaders.size()), ENTITY_CHUNK_SIZE, [&](uint32 begin, uint32 end)
 			{
-				Transform& transform = transformArray[entityId.first];
-
-				if (movementDirection == Direction::Left)
+				for (uint32 i = begin; i < end; i++)
 				{
-					transform.Position.x -= INVADER_SPEED;
+					transformArray.Get(invaders[i]).Position.x += step;
 				}
-				else if (movementDirection == Direction::Right)
-				{
-					transform.Position.x += INVADER_SPEED;
-				}
-			}
+			});
 
 			Direction prevMovementDirection = movementDirection;
 			// Check if we should start moving to the other side of the screen
-			for (auto entityId : invaderArray)
+			for (const Entity entityId : invaderArray.GetEntities())
 			{
-				Transform& transform = transformArray[entityId.first];
-				const Renderable_Sprite& sprite = renderableSpriteArray[entityId.first];
+				const Transform& transform = transformArray.Get(entityId);
+				const Renderable_Sprite& sprite = renderableSpriteArray.Get(entityId);
 
 				if (movementDirection == Direction::Right)
 				{
@@ -532,11 +587,13 @@ public:
 			// Move all space invaders down
 			if (prevMovementDirection != movementDirection)
 			{
-				for (auto entityId : invaderArray)
+				jobs.ParallelFor(Cast<uint32>(invaders.size()), ENTITY_CHUNK_SIZE, [&](uint32 begin, uint32 end)
 				{
-					Transform& transform = transformArray[entityId.first];
-					transform.Position.y += 15.f;
-				}
+					for (uint32 i = begin; i < end; i++)
+					{
+						transformArray.Get(invaders[i]).Position.y += 15.f;
+					}
+				});
 			}
 			timer -= INVADER_MOVE_STEP_TIME;
 		}
@@ -549,44 +606,66 @@ SquareRenderManager squareRenderManager;
 
 ControllerManager controllerManager;
 BulletManager bulletManager;
+BroadphaseManager broadphaseManager;
 InvaderManager invaderManager;
 PlayerBulletManager playerBulletManager;
 InvaderBulletManager invaderBulletManager;
 
 CollisionRenderManager debugCollisionRenderManager;
 
+// Systems in the order GameTick used to call them, the graph only runs the ones with disjoint data at the same time
+void BuildGameSystems()
+{
+	gameSystems.Clear();
+	gameSystems.Add("Controllers", { { &playerControlArray, &attributesArray }, { &transformArray, &playerBulletPool } }, [](float deltaTime) { controllerManager.Update(deltaTime); });
+	// Also the only user of std::rand during a tick
+	gameSystems.Add("Invaders", { { &invaderArray, &renderableSpriteArray }, { &transformArray, &enemyBulletPool } }, [](float deltaTime) { invaderManager.Update(deltaTime); });
+	gameSystems.Add("Bullets", { {}, { &playerBulletPool, &enemyBulletPool } }, [](float deltaTime) { bulletManager.Update(deltaTime); });
+	gameSystems.Add("InvaderGrid", { { &transformArray, &collisionBoxArray, &invaderArray }, { &invaderGrid } }, [](float deltaTime) { broadphaseManager.UpdateInvaders(deltaTime); });
+	gameSystems.Add("ObstacleGrid", { { &transformArray, &collisionBoxArray, &obstacleArray }, { &obstacleGrid } }, [](float deltaTime) { broadphaseManager.UpdateObstacles(deltaTime); });
+	// Deleting an invader touches all of its stores
+	gameSystems.Add("PlayerBullets", { { &invaderGrid, &obstacleGrid }, { &playerBulletPool, &entityRegistry, &transformArray, &attributesArray, &collisionBoxArray, &renderableSpriteArray, &invaderArray, &assets, &playerScore } }, [](float deltaTime) { playerBulletManager.Update(deltaTime); });
+	gameSystems.Add("InvaderBullets", { { &obstacleGrid, &transformArray, &collisionBoxArray }, { &enemyBulletPool, &attributesArray, &renderableSpriteArray, &isInMenu } }, [](float deltaTime) { invaderBulletManager.Update(deltaTime); });
+
+	gameSystems.Add("RenderImages", { { &renderableImagesArray, &transformArray, &assets }, { &renderQueue } }, [](float deltaTime) { renderManager.Update(deltaTime); });
+	gameSystems.Add("RenderSprites", { { &transformArray, &assets }, { &renderableSpriteArray, &renderQueue } }, [](float deltaTime) { spriteRenderManager.Update(deltaTime); });
+	gameSystems.Add("RenderSquares", { { &renderableSquareArray, &transformArray, &playerBulletPool, &enemyBulletPool }, { &renderQueue } }, [](float deltaTime) { squareRenderManager.Update(deltaTime); });
+}
+
 void CreateSpaceInvader(const Vector2D& inPos)
 {
-	const int32 newId = NewId();
-	transformArray[newId] = Transform{inPos , Vector2D { 0.5f, 0.5f }};
+	const Entity newId = NewId();
+	const Transform& transform = transformArray.Add(newId, Transform{inPos , Vector2D { 0.5f, 0.5f }});
 			
-	const int32 assetId = GetAssetId("Assets/SpaceInvader/Invader_01.png");
-	const Renderable_Sprite sprite = Renderable_Sprite { newId, assetId, 2, 1};
-	renderableSpriteArray[newId] = sprite;
+	assets.AddRef(invaderAsset);
+	const Renderable_Sprite sprite = Renderable_Sprite { invaderAsset, 2, 1};
+	renderableSpriteArray.Add(newId, sprite);
 			
-	collisionBoxArray[newId] = CollisionBox { newId,  { sprite.SpriteCellSize.x * transformArray[newId].Scale.x , sprite.SpriteCellSize.y * transformArray[newId].Scale.y } };
-	invaderArray[newId] = true;	
+	collisionBoxArray.Add(newId, CollisionBox { { sprite.SpriteCellSize.x * transform.Scale.x , sprite.SpriteCellSize.y * transform.Scale.y } });
+	invaderArray.Add(newId);	
 }
 
-void DeleteSpaceInvader(int32 entityId)
+void DeleteSpaceInvader(Entity entityId)
 {
-	transformArray.erase(entityId);
-	renderableSpriteArray.erase(entityId);
-	collisionBoxArray.erase(entityId);
-	invaderArray.erase(entityId);
+	assets.Release(renderableSpriteArray.Get(entityId).asset);
+	transformArray.Remove(entityId);
+	renderableSpriteArray.Remove(entityId);
+	collisionBoxArray.Remove(entityId);
+	invaderArray.Remove(entityId);
+	entityRegistry.Destroy(entityId);
 }
 
 void CreateObstacle(const Vector2D& pos)
 {
-	const int32 newId = NewId();
-	transformArray[newId] = Transform { pos, Vector2D{ 0.25f, 0.25f } };
-	attributesArray[newId] = Attributes { 0.f, 4 };
-	const int32 assetId = GetAssetId("Assets/SpaceInvader/Obstacle_01.png");
-	Renderable_Sprite sprite = Renderable_Sprite { newId, assetId, 4, 1};
+	const Entity newId = NewId();
+	const Transform& transform = transformArray.Add(newId, Transform { pos, Vector2D{ 0.25f, 0.25f } });
+	attributesArray.Add(newId, Attributes { 0.f, 4 });
+	assets.AddRef(obstacleAsset);
+	Renderable_Sprite sprite = Renderable_Sprite { obstacleAsset, 4, 1};
 	sprite.update = false;
-	renderableSpriteArray[newId] = sprite;
-	collisionBoxArray[newId] = CollisionBox { newId,  { sprite.SpriteCellSize.x * transformArray[newId].Scale.x , sprite.SpriteCellSize.y * transformArray[newId].Scale.y } };
-	obstacleArray[newId] = true;	
+	renderableSpriteArray.Add(newId, sprite);
+	collisionBoxArray.Add(newId, CollisionBox { { sprite.SpriteCellSize.x * transform.Scale.x , sprite.SpriteCellSize.y * transform.Scale.y } });
+	obstacleArray.Add(newId);	
 }
 
 void CreateObstacleCluster(const Vector2D& pos)
@@ -604,37 +683,50 @@ void CreateObstacleCluster(const Vector2D& pos)
 
 void Start()
 {
-	srand (static_cast <unsigned> (time(0)));
-
-	transformArray.clear();
-	attributesArray.clear();
-	renderableImagesArray.clear();
-	renderableSpriteArray.clear();
-	renderableSquareArray.clear();
-	collisionBoxArray.clear();
-	playerControlArray.clear();
-	bulletArray.clear();
-	playerBulletArray.clear();
-	enemyBulletArray.clear();
-	invaderArray.clear();
-	imageAssetArray.clear();
+	srand(MakeRandomSeed());
+	renderQueue.SetJobSystem(&jobs);
+	BuildGameSystems();
+
+	entityRegistry.Clear();
+	transformArray.Clear();
+	attributesArray.Clear();
+	renderableImagesArray.Clear();
+	renderableSpriteArray.Clear();
+	renderableSquareArray.Clear();
+	collisionBoxArray.Clear();
+	playerControlArray.Clear();
+	playerBulletPool.Clear();
+	enemyBulletPool.Clear();
+	playerBulletPool.Reserve(BULLET_POOL_SIZE);
+	enemyBulletPool.Reserve(BULLET_POOL_SIZE);
+	invaderArray.Clear();
+	obstacleArray.Clear();
+	// Every entity is gone, so are the references they held
+	assets.Clear();
+	if (!assetPack.IsOpen() && assetPack.Open("Assets.pack"))
+	{
+		assets.MountPack(&assetPack);
+	}
+	const std::vector<AssetHandle> levelAssets = assets.Acquire({ "Assets/SpaceInvader/Invader_01.png", "Assets/SpaceInvader/Obstacle_01.png", "Assets/SpaceInvader/Spaceship.png" });
+	invaderAsset = levelAssets[0];
+	obstacleAsset = levelAssets[1];
 
 	playerScore = 0;
 	
 	// Creating new player
 	{
-		const int32 newId = NewId();
-		transformArray[newId] = Transform{Vector2D{Cast<float>(Width / 2), Cast<float>(Height - 10)}};
-		const Vector2D& scale = transformArray[newId].Scale;
-		const int32 assetId =GetAssetId("Assets/SpaceInvader/Spaceship.png");
-		renderableImagesArray[newId] = Renderable_Image { newId, assetId};
-		const SImage& image = imageAssetArray[assetId];
-		playerControlArray[newId] = PlayerControl{ newId };
-		attributesArray[newId] = Attributes {100.f, 3 };
+		const Entity newId = NewId();
+		const Transform& transform = transformArray.Add(newId, Transform{Vector2D{Cast<float>(Width / 2), Cast<float>(Height - 10)}});
+		// The player holds the reference levelAssets took
+		const AssetHandle spaceshipAsset = levelAssets[2];
+		renderableImagesArray.Add(newId, Renderable_Image { spaceshipAsset });
+		const SImage& image = assets.GetImage(spaceshipAsset);
+		playerControlArray.Add(newId, PlayerControl{ newId });
+		attributesArray.Add(newId, Attributes {100.f, 3 });
 		
-		Vector2D collisionScale { image.width * transformArray[newId].Scale.x, image.height * transformArray[newId].Scale.y * 0.5f };
+		Vector2D collisionScale { image.width * transform.Scale.x, image.height * transform.Scale.y * 0.5f };
 		Vector2D offset {-image.width * 0.5f, 0.f };
-		collisionBoxArray[newId] = CollisionBox { newId, collisionScale, offset };
+		collisionBoxArray.Add(newId, CollisionBox { collisionScale, offset });
 		playerEntityId = newId;
 	}
 
@@ -664,7 +756,8 @@ void Start()
 
 void RenderGameUI()
 {
-	Attributes& attributes = attributesArray[playerEntityId];
+	SPROFILE_SCOPE("RenderGameUI");
+	const Attributes& attributes = attributesArray.Get(playerEntityId);
 	const std::string score = "SCORE " + std::to_string(playerScore);
 	DrawString(Vector2D{5.f, 5.f }, score, Alignment::Left, White, 2);
 	const std::string lives = "LIVES " + std::to_string(attributes.HEALTH); 
@@ -696,15 +789,9 @@ void MainMenu(float deltaTime)
 
 void GameTick(float deltaTime)
 {
-	controllerManager.Update(deltaTime);
-	invaderManager.Update(deltaTime);
-	bulletManager.Update(deltaTime);
-	playerBulletManager.Update(deltaTime);
-	invaderBulletManager.Update(deltaTime);
-	
-	renderManager.Update(deltaTime);
-	spriteRenderManager.Update(deltaTime);
-	squareRenderManager.Update(deltaTime);
+	SPROFILE_SCOPE("GameTick");
+	gameSystems.Run(jobs, deltaTime);
+	renderQueue.Flush();
 
 	//debugCollisionRenderManager.Update(deltaTime);
 	